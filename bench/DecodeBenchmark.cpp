@@ -0,0 +1,240 @@
+/* Times the bitmap decoders of VramBitMappedView on random VRAM, one
+ * thread, against the setPixel() based decoders they replaced, which are
+ * kept here as the reference.
+ *
+ * Build and run:
+ *   cd bench && qmake && make && ./DecodeBenchmark [decodes per mode]
+ */
+#include "VramBitMappedView.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+static const int LINES = 212;
+
+template <int LO, int HI>
+static inline int clip(int x)
+{
+	return unsigned(x - LO) <= unsigned(HI - LO) ? x : (x < HI ? LO : HI);
+}
+
+static unsigned interleave(unsigned x)
+{
+	return (x >> 1) | ((x & 1) << 16);
+}
+
+/** The decoders as they were before they wrote into the image lines.
+  */
+class ReferenceDecoder
+{
+public:
+	ReferenceDecoder(const unsigned char* vram_, const QRgb* pallet_)
+		: image(512, 512, QImage::Format_RGB32)
+		, vram(vram_)
+		, pallet(pallet_)
+	{
+	}
+
+	void decode(int mode)
+	{
+		switch (mode) {
+		case 12: decodeSCR12(); break;
+		case 11:
+		case 10: decodeSCR10(); break;
+		case 8:  decodeSCR8();  break;
+		case 7:  decodeSCR7();  break;
+		case 6:  decodeSCR6();  break;
+		case 5:  decodeSCR5();  break;
+		}
+	}
+
+private:
+	void setPixel2x2(int x, int y, QRgb c)
+	{
+		image.setPixel(2 * x + 0, 2 * y + 0, c);
+		image.setPixel(2 * x + 1, 2 * y + 0, c);
+		image.setPixel(2 * x + 0, 2 * y + 1, c);
+		image.setPixel(2 * x + 1, 2 * y + 1, c);
+	}
+
+	void setPixel1x2(int x, int y, QRgb c)
+	{
+		image.setPixel(x, 2 * y + 0, c);
+		image.setPixel(x, 2 * y + 1, c);
+	}
+
+	QRgb yjk(int z, int j, int k)
+	{
+		int r = clip<0, 31>(z + j);
+		int g = clip<0, 31>(z + k);
+		int b = clip<0, 31>((5 * z - 2 * j - k) / 4);
+		r = (r << 3) | (r >> 2);
+		b = (b << 3) | (b >> 2);
+		g = (g << 3) | (g >> 2);
+		return qRgb(r, g, b);
+	}
+
+	void decodeSCR12()
+	{
+		int offset = 0;
+		for (int y = 0; y < LINES; ++y) {
+			for (int x = 0; x < 256; x += 4) {
+				unsigned p[4];
+				p[0] = vram[interleave(offset++)];
+				p[1] = vram[interleave(offset++)];
+				p[2] = vram[interleave(offset++)];
+				p[3] = vram[interleave(offset++)];
+				int j = (p[2] & 7) + ((p[3] & 3) << 3) - ((p[3] & 4) << 3);
+				int k = (p[0] & 7) + ((p[1] & 3) << 3) - ((p[1] & 4) << 3);
+				for (unsigned n = 0; n < 4; ++n) {
+					setPixel2x2(x + n, y, yjk(p[n] >> 3, j, k));
+				}
+			}
+		}
+	}
+
+	void decodeSCR10()
+	{
+		int offset = 0;
+		for (int y = 0; y < LINES; ++y) {
+			for (int x = 0; x < 256; x += 4) {
+				unsigned p[4];
+				p[0] = vram[interleave(offset++)];
+				p[1] = vram[interleave(offset++)];
+				p[2] = vram[interleave(offset++)];
+				p[3] = vram[interleave(offset++)];
+				int j = (p[2] & 7) + ((p[3] & 3) << 3) - ((p[3] & 4) << 3);
+				int k = (p[0] & 7) + ((p[1] & 3) << 3) - ((p[1] & 4) << 3);
+				for (unsigned n = 0; n < 4; ++n) {
+					QRgb c = (p[n] & 0x08) ? pallet[p[n] >> 4]
+					                       : yjk(p[n] >> 3, j, k);
+					setPixel2x2(x + n, y, c);
+				}
+			}
+		}
+	}
+
+	void decodeSCR8()
+	{
+		int offset = 0;
+		for (int y = 0; y < LINES; ++y) {
+			for (int x = 0; x < 256; ++x) {
+				unsigned char val = vram[interleave(offset++)];
+				int b = val & 0x03;
+				int r = val & 0x1C;
+				int g = val & 0xE0;
+				b = b | (b << 2) | (b << 4) | (b << 6);
+				r = (r >> 2) | r | (r << 3);
+				g = g | (g >> 3) | (g >> 6);
+				setPixel2x2(x, y, qRgb(r, g, b));
+			}
+		}
+	}
+
+	void decodeSCR7()
+	{
+		int offset = 0;
+		for (int y = 0; y < LINES; ++y) {
+			for (int x = 0; x < 512; x += 2) {
+				int val = vram[interleave(offset++)];
+				setPixel1x2(x + 0, y, pallet[(val >> 4) & 15]);
+				setPixel1x2(x + 1, y, pallet[(val >> 0) & 15]);
+			}
+		}
+	}
+
+	void decodeSCR6()
+	{
+		int offset = 0;
+		for (int y = 0; y < LINES; ++y) {
+			for (int x = 0; x < 512; x += 4) {
+				int val = vram[offset++];
+				setPixel1x2(x + 0, y, pallet[(val >> 6) & 3]);
+				setPixel1x2(x + 1, y, pallet[(val >> 4) & 3]);
+				setPixel1x2(x + 2, y, pallet[(val >> 2) & 3]);
+				setPixel1x2(x + 3, y, pallet[(val >> 0) & 3]);
+			}
+		}
+	}
+
+	void decodeSCR5()
+	{
+		int offset = 0;
+		for (int y = 0; y < LINES; ++y) {
+			for (int x = 0; x < 256; x += 2) {
+				int val = vram[offset++];
+				setPixel2x2(x + 0, y, pallet[(val >> 4) & 15]);
+				setPixel2x2(x + 1, y, pallet[(val >> 0) & 15]);
+			}
+		}
+	}
+
+	QImage image;
+	const unsigned char* vram;
+	const QRgb* pallet;
+};
+
+
+class DecodeBenchmark
+{
+public:
+	static void run(int count)
+	{
+		static unsigned char vram[0x20000 + 32];
+		srand(1);
+		for (unsigned i = 0; i < sizeof(vram); ++i) vram[i] = rand();
+
+		VramBitMappedView view;
+		view.vramBase = vram;
+		view.vramAddress = 0;
+		view.pallet = vram + 0x20000;
+		view.decodePallet();
+		ReferenceDecoder reference(vram, view.msxpallet);
+
+		printf("mode  setPixel (ms)  lines (ms)  speedup\n");
+		static const int modes[] = { 5, 6, 7, 8, 10, 11, 12 };
+		for (int m = 0; m < 7; ++m) {
+			int mode = modes[m];
+			QElapsedTimer timer;
+			timer.start();
+			for (int i = 0; i < count; ++i) reference.decode(mode);
+			double old = timer.nsecsElapsed() / 1e6 / count;
+
+			view.screenMode = mode;
+			view.copyState();
+			view.state.bits = view.image.bits();
+			view.state.bytesPerLine = view.image.bytesPerLine();
+			timer.restart();
+			for (int i = 0; i < count; ++i) decode(view.state, mode);
+			double now = timer.nsecsElapsed() / 1e6 / count;
+
+			printf("SCR%-2d %13.3f %11.3f %7.1fx\n", mode, old, now, old / now);
+		}
+	}
+
+private:
+	static void decode(const VramBitMappedView::DecodeState& s, int mode)
+	{
+		switch (mode) {
+		case 12: VramBitMappedView::decodeSCR12(s, 0, LINES); break;
+		case 11:
+		case 10: VramBitMappedView::decodeSCR10(s, 0, LINES); break;
+		case 8:  VramBitMappedView::decodeSCR8 (s, 0, LINES); break;
+		case 7:  VramBitMappedView::decodeSCR7 (s, 0, LINES); break;
+		case 6:  VramBitMappedView::decodeSCR6 (s, 0, LINES); break;
+		case 5:  VramBitMappedView::decodeSCR5 (s, 0, LINES); break;
+		}
+	}
+};
+
+
+int main(int argc, char* argv[])
+{
+	QApplication app(argc, argv);
+	int count = argc > 1 ? atoi(argv[1]) : 200;
+	DecodeBenchmark::run(std::max(1, count));
+	return 0;
+}
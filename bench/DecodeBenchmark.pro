@@ -0,0 +1,9 @@
+# standalone benchmark of the bitmap decoders, see DecodeBenchmark.cpp
+TEMPLATE = app
+TARGET = DecodeBenchmark
+QT += widgets xml network
+CONFIG += c++11 release console
+CONFIG -= app_bundle
+INCLUDEPATH += ../src
+HEADERS += ../src/VramBitMappedView.h
+SOURCES += DecodeBenchmark.cpp ../src/VramBitMappedView.cpp
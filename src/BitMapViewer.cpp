@@ -2,6 +2,7 @@
 #include "VramBitMappedView.h"
 #include "VDPDataStore.h"
 #include <QMessageBox>
+#include <algorithm>
 
 static const unsigned char defaultPalette[32] = {
 //        RB  G
@@ -45,6 +46,7 @@ BitMapViewer::BitMapViewer(QWidget* parent)
 	scrollArea->setWidget(imageWidget);
 
 	useVDP = true;
+	shownSerial = -1;
 
 	const unsigned char* vram    = VDPDataStore::instance().getVramPointer();
 	const unsigned char* palette = VDPDataStore::instance().getPalettePointer();
@@ -53,25 +55,47 @@ BitMapViewer::BitMapViewer(QWidget* parent)
 	imageWidget->setPaletteSource(palette);
 
 	//now hook up some signals and slots
-	connect(&VDPDataStore::instance(), SIGNAL(dataRefreshed()),
-	        this, SLOT(VDPDataStoreDataRefreshed()));
-	connect(&VDPDataStore::instance(), SIGNAL(dataRefreshed()),
+	// only what changed since the previous refresh is decoded again
+	connect(&VDPDataStore::instance(), SIGNAL(regsChanged()),
+	        this, SLOT(VDPDataStoreRegsChanged()));
+	connect(&VDPDataStore::instance(), SIGNAL(vramChanged(const QList<VramRange>&)),
+	        imageWidget, SLOT(vramChanged(const QList<VramRange>&)));
+	connect(&VDPDataStore::instance(), SIGNAL(paletteChanged()),
 	        imageWidget, SLOT(refresh()));
 	connect(refreshButton, SIGNAL(clicked(bool)),
 	        &VDPDataStore::instance(), SLOT(refresh()));
+	connect(&VDPDataStore::instance(), SIGNAL(liveChanged(bool)),
+	        this, SLOT(liveChanged(bool)));
+	liveUpdate->setChecked(VDPDataStore::instance().isLive());
+	connect(&VDPDataStore::instance(), SIGNAL(dataRefreshed()),
+	        this, SLOT(historyChanged()));
 
 	connect(imageWidget, SIGNAL(imagePosition(int,int,int,unsigned int,int)),
 	        this, SLOT(imagePositionUpdate(int,int,int,unsigned int,int)));
 	connect(imageWidget, SIGNAL(imageClicked (int,int,int,unsigned int,int)),
 	        this, SLOT(imagePositionUpdate(int,int,int,unsigned int,int)));
 
+	// the store only signals what differs from its previous fetch, so
+	// start from the data it already has; another viewer may have fetched
+	// the same registers before
+	decodeVDPregs();
+
 	// and now go fetch the initial data
 	VDPDataStore::instance().refresh();
 }
 
+BitMapViewer::~BitMapViewer()
+{
+	// live mode is only useful while someone is watching
+	if (liveUpdate->isChecked()) VDPDataStore::instance().stopLive();
+}
+
 void BitMapViewer::decodeVDPregs()
 {
-	const unsigned char* regs = VDPDataStore::instance().getRegsPointer();
+	// the registers of the shown snapshot
+	const unsigned char* regs = shownData() +
+		(VDPDataStore::instance().getRegsPointer() -
+		 VDPDataStore::instance().getVramPointer());
 
 	// Get the number of lines
 	int v1 = (regs[9] & 128) ? 212 : 192;
@@ -168,10 +192,14 @@ void BitMapViewer::on_screenMode_currentIndexChanged(const QString& text)
 	// starting vram address....
 	imageWidget->setScreenMode(screenMod);
 	setPages();
+	showPage->setCurrentIndex(0);
 }
 
 void BitMapViewer::setPages()
 {
+	int pages = (screenMod < 7 && VDPDataStore::instance().getVRAMSize() > 0x10000) ? 4 : 2;
+	// refilling the list would select page 0 and decode it
+	if (showPage->count() == pages) return;
 	showPage->clear();
 	showPage->insertItem(0, "0");
 	showPage->insertItem(1, "1");
@@ -224,6 +252,28 @@ void BitMapViewer::on_zoomLevel_valueChanged(double d)
 	imageWidget->setZoom(float(d));
 }
 
+void BitMapViewer::on_liveUpdate_toggled(bool checked)
+{
+	if (checked) {
+		VDPDataStore::instance().startLive(liveRate->value());
+	} else {
+		VDPDataStore::instance().stopLive();
+	}
+}
+
+void BitMapViewer::on_liveRate_valueChanged(int fps)
+{
+	if (VDPDataStore::instance().isLive()) {
+		VDPDataStore::instance().startLive(fps);
+	}
+}
+
+void BitMapViewer::liveChanged(bool live)
+{
+	liveUpdate->setChecked(live);
+	refreshButton->setEnabled(!live);
+}
+
 void BitMapViewer::on_saveImageButton_clicked(bool checked)
 {
 	QMessageBox::information(
@@ -245,7 +295,7 @@ void BitMapViewer::on_editPaletteButton_clicked(bool checked)
 void BitMapViewer::on_useVDPPalette_stateChanged(int state)
 {
 	if (state) {
-		const unsigned char* palette = VDPDataStore::instance().getPalettePointer();
+		const unsigned char* palette = shownData() + VDPDataStore::instance().getVRAMSize();
 		imageWidget->setPaletteSource(palette);
 	} else {
 		imageWidget->setPaletteSource(defaultPalette);
@@ -261,11 +311,90 @@ void BitMapViewer::on_refreshButton_clicked(bool checked)
 }
 */
 
-void BitMapViewer::VDPDataStoreDataRefreshed()
+void BitMapViewer::VDPDataStoreRegsChanged()
+{
+	decodeVDPregs();
+}
+
+const unsigned char* BitMapViewer::shownData() const
 {
+	if (shownSerial == -1) return VDPDataStore::instance().getVramPointer();
+	return reinterpret_cast<const unsigned char*>(shownFrame.constData());
+}
+
+// the view reads a whole bitmap page past the end of a small VRAM
+static void padFrame(QByteArray& frame)
+{
+	static const int MIN_SIZE = 0x20000;
+	if (frame.size() < MIN_SIZE) frame.append(QByteArray(MIN_SIZE - frame.size(), 0));
+}
+
+void BitMapViewer::showSnapshot()
+{
+	VramHistory& history = VDPDataStore::instance().getHistory();
+	if (shownSerial != -1) {
+		if (history.snapshot(shownSerial, shownFrame)) {
+			padFrame(shownFrame);
+		} else {
+			shownSerial = -1;
+		}
+	}
+	const unsigned char* data = shownData();
+	imageWidget->setVramSource(data);
+	if (useVDPPalette->isChecked()) {
+		imageWidget->setPaletteSource(data + VDPDataStore::instance().getVRAMSize());
+	}
+
+	// compare with the snapshot before the shown one
+	int serial = (shownSerial == -1) ? history.newest() : shownSerial;
+	if (showChanges->isChecked() && history.snapshot(serial - 1, previousFrame)) {
+		padFrame(previousFrame);
+		imageWidget->setDiffSource(
+			reinterpret_cast<const unsigned char*>(previousFrame.constData()));
+	} else {
+		imageWidget->setDiffSource(NULL);
+	}
+
+	if (shownSerial == -1) {
+		historyLabel->setText(tr("newest"));
+	} else {
+		historyLabel->setText(tr("%1 back").arg(history.newest() - shownSerial));
+	}
 	decodeVDPregs();
 }
 
+void BitMapViewer::historyChanged()
+{
+	VramHistory& history = VDPDataStore::instance().getHistory();
+	// the shown snapshot can be dropped from the history
+	bool dropped = shownSerial != -1 && shownSerial < history.oldest();
+	if (dropped) shownSerial = -1;
+
+	historySlider->blockSignals(true);
+	historySlider->setRange(history.oldest(), std::max(history.oldest(), history.newest()));
+	historySlider->setValue((shownSerial == -1) ? history.newest() : shownSerial);
+	historySlider->blockSignals(false);
+
+	if (dropped || (shownSerial == -1 && showChanges->isChecked())) {
+		// the changes are relative to the new snapshot before
+		showSnapshot();
+	} else if (shownSerial != -1) {
+		historyLabel->setText(tr("%1 back").arg(history.newest() - shownSerial));
+	}
+}
+
+void BitMapViewer::on_historySlider_valueChanged(int value)
+{
+	VramHistory& history = VDPDataStore::instance().getHistory();
+	shownSerial = (value >= history.newest()) ? -1 : value;
+	showSnapshot();
+}
+
+void BitMapViewer::on_showChanges_toggled(bool checked)
+{
+	showSnapshot();
+}
+
 void BitMapViewer::imagePositionUpdate(
 	int x, int y, int color, unsigned addr, int byteValue)
 {
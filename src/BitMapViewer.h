@@ -3,6 +3,7 @@
 
 #include "ui_BitMapViewer.h"
 #include <QDialog>
+#include <QByteArray>
 
 class VramBitMappedView;
 
@@ -11,14 +12,21 @@ class BitMapViewer : public QDialog, private Ui::BitMapViewer
 	Q_OBJECT
 public:
 	BitMapViewer(QWidget* parent = 0);
+	~BitMapViewer();
 
 private:
 	void decodeVDPregs();
 	void setPages();
+	void showSnapshot();
+	const unsigned char* shownData() const;
 
 	VramBitMappedView* imageWidget;
 	int screenMod;
 	bool useVDP;
+	// serial number of the shown snapshot, -1 follows the newest data
+	int shownSerial;
+	QByteArray shownFrame;
+	QByteArray previousFrame;
 
 private slots:
 	void refresh();
@@ -34,10 +42,16 @@ private slots:
 	void on_editPaletteButton_clicked(bool checked);
 	void on_useVDPPalette_stateChanged(int state);
 	void on_zoomLevel_valueChanged(double d);
+	void on_liveUpdate_toggled(bool checked);
+	void on_liveRate_valueChanged(int fps);
+	void liveChanged(bool live);
+	void on_historySlider_valueChanged(int value);
+	void on_showChanges_toggled(bool checked);
+	void historyChanged();
 
 	void imagePositionUpdate(int x, int y, int color, unsigned addr, int byteValue);
 
-	void VDPDataStoreDataRefreshed();
+	void VDPDataStoreRegsChanged();
 };
 
 #endif /* BITMAPVIEWER_OPENMSX_H */
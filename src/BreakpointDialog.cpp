@@ -1,7 +1,7 @@
 #include "BreakpointDialog.h"
 #include "DebugSession.h"
+#include "LabelCompleter.h"
 #include "Convert.h"
-#include <QCompleter>
 #include <QStandardItemModel>
 
 BreakpointDialog::BreakpointDialog(const MemoryLayout& ml, DebugSession *session, QWidget* parent)
@@ -14,10 +14,11 @@ BreakpointDialog::BreakpointDialog(const MemoryLayout& ml, DebugSession *session
 	debugSession = session;
 	if( session ) {
 		// create address completer
-		jumpCompleter = new QCompleter(session->symbolTable().labelList(), this);
-		allCompleter = new QCompleter(session->symbolTable().labelList(true), this);
-		jumpCompleter->setCaseSensitivity(Qt::CaseInsensitive);
-		allCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+		jumpCompleter = new LabelCompleter(session->symbolTable(), false, this);
+		allCompleter = new LabelCompleter(session->symbolTable(), true, this);
+		connect(edtAddress,      SIGNAL(textEdited(const QString&)), jumpCompleter, SLOT(setPrefix(const QString&)));
+		connect(edtAddress,      SIGNAL(textEdited(const QString&)), allCompleter,  SLOT(setPrefix(const QString&)));
+		connect(edtAddressRange, SIGNAL(textEdited(const QString&)), allCompleter,  SLOT(setPrefix(const QString&)));
 		connect(jumpCompleter, SIGNAL(activated(const QString&)), this, SLOT(addressChanged(const QString&)));
 		connect(allCompleter,  SIGNAL(activated(const QString&)), this, SLOT(addressChanged(const QString&)));
 	}
@@ -74,6 +75,14 @@ int BreakpointDialog::segment()
 	return cmbxSegment->currentIndex() - 1;
 }
 
+QString BreakpointDialog::logMessage()
+{
+	if (type() == Breakpoints::TRACEPOINT)
+		return edtLog->text().trimmed();
+	else
+		return QString();
+}
+
 QString BreakpointDialog::condition()
 {
 	if( cbCondition->checkState() == Qt::Checked )
@@ -83,7 +92,7 @@ QString BreakpointDialog::condition()
 }
 
 void BreakpointDialog::setData(Breakpoints::Type type, int address, int ps, int ss, int segment,
-                               int addressEnd, QString condition)
+                               int addressEnd, QString condition, QString log)
 {
 	// set type
 	cmbxType->setCurrentIndex(int(type));
@@ -123,6 +132,9 @@ void BreakpointDialog::setData(Breakpoints::Type type, int address, int ps, int
 	if (cbCondition->isChecked() == condition.isEmpty())
 		cbCondition->setChecked(!condition.isEmpty());
 	txtCondition->setText(condition);
+
+	// log message
+	edtLog->setText(log);
 }
 
 void BreakpointDialog::addressChanged(const QString& text)
@@ -222,12 +234,21 @@ void BreakpointDialog::typeChanged(int s)
 			edtAddress->setCompleter(0);
 			edtAddressRange->setCompleter(0);
 			break;
+		case 6:
+			lblAddress->setText(tr("Add tracepoint at address:"));
+			edtAddressRange->setVisible(false);
+			edtAddress->setCompleter(jumpCompleter);
+			break;
 		default:
 			lblAddress->setText(tr("Add breakpoint at address:"));
 			edtAddressRange->setVisible(false);
 			edtAddress->setCompleter(jumpCompleter);
 	}
 
+	// a tracepoint logs instead of breaking
+	lblLog->setVisible(s == 6);
+	edtLog->setVisible(s == 6);
+
 	switch(s) {
 		case 1:
 		case 2:
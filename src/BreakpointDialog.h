@@ -9,6 +9,7 @@ struct MemoryLayout;
 
 class DebugSession;
 class Symbol;
+class LabelCompleter;
 
 class BreakpointDialog : public QDialog, private Ui::BreakpointDialog
 {
@@ -24,10 +25,12 @@ public:
 	int subslot();
 	int segment();
 	QString condition();
+	QString logMessage();
 
 	void setData(Breakpoints::Type type, int address = -1, 
 	             int ps = -1, int ss = -1, int segment = -1,
-	             int addressEnd = -1, QString condition = QString());
+	             int addressEnd = -1, QString condition = QString(),
+	             QString log = QString());
 
 private:
 	const MemoryLayout& memLayout;
@@ -37,7 +40,7 @@ private:
 	int idxSlot, idxSubSlot;
 	int value, valueEnd;
 	int conditionHeight;
-	QCompleter *jumpCompleter, *allCompleter;
+	LabelCompleter *jumpCompleter, *allCompleter;
 
 private slots:
 	void addressChanged(const QString& text);
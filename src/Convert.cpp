@@ -71,3 +71,11 @@ QString& unescapeXML(QString& str)
 {
 	return str.replace("&amp;", "&").replace("&lt;", "<").replace("&gt;", ">");
 }
+
+void hexToBytes(const QChar* hex, unsigned size, unsigned char* target)
+{
+	for (unsigned i = 0; i < size; ++i) {
+		target[i] = (hexDigitValue(hex[2 * i + 0].unicode()) << 4) |
+		            (hexDigitValue(hex[2 * i + 1].unicode()) << 0);
+	}
+}
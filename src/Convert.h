@@ -2,10 +2,22 @@
 #define CONVERT_H
 
 class QString;
+class QChar;
 
 int stringToValue(const QString& str);
 QString hexValue(int value, int width = 0);
 QString& escapeXML(QString& str);
 QString& unescapeXML(QString& str);
 
+/** The value of a hexadecimal digit, upper or lower case. Replies from
+  * openMSX are trusted, so the digit isn't checked.
+  */
+inline int hexDigitValue(int c)
+{
+	return (c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10);
+}
+
+/** Decodes size bytes from the 2 * size hexadecimal digits at hex. */
+void hexToBytes(const QChar* hex, unsigned size, unsigned char* target);
+
 #endif // CONVERT_H
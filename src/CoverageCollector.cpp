@@ -0,0 +1,164 @@
+#include "CoverageCollector.h"
+#include "CommClient.h"
+#include "OpenMSXConnection.h"
+#include "Convert.h"
+#include "DebuggerData.h"
+
+// length of a single entry in the fetched data: PPPP S s GGG
+static const int ENTRY_LENGTH = 9;
+
+
+CoverageCollector::CoverageCollector(CoverageMap& coverage_, QObject* parent)
+	: QObject(parent)
+	, coverage(coverage_)
+	, fetcher("debug_coverage_fetch",
+	          [this](const QString& data) { addAddresses(data); })
+{
+	running = false;
+
+	fetchTimer.setInterval(1000);
+	connect(&fetchTimer, SIGNAL(timeout()), this, SLOT(fetch()));
+	connect(&CommClient::instance(), SIGNAL(connectionTerminated()),
+	        this, SLOT(connectionClosed()));
+}
+
+bool CoverageCollector::isRunning() const
+{
+	return running;
+}
+
+void CoverageCollector::start()
+{
+	if (running) return;
+
+	// the slot key of every 8kB block is cached, so the hook that runs for
+	// every instruction only looks up PC in arrays; the keys are computed
+	// again before the next instruction after a write to the slot select
+	// or mapper ports, to the subslot register or into a ROM with a mapper
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_hook_coverage_remap { } {\n"
+		"  set ::debug_coverage_dirty 1\n"
+		"}\n"
+		"proc debug_coverage_keys { } {\n"
+		"  set ::debug_coverage_dirty 0\n"
+		"  foreach id $::debug_coverage_rom_ids { debug remove_watchpoint $id }\n"
+		"  set ::debug_coverage_rom_ids [list]\n"
+		"  for { set b 0 } { $b &lt; 8 } { incr b } {\n"
+		"    set ::debug_coverage_key($b) [debug_slot_key [expr {$b &lt;&lt; 13}]]\n"
+		"  }\n"
+		"  for { set page 0 } { $page &lt; 4 } { incr page } {\n"
+		"    set key $::debug_coverage_key([expr {2 * $page}])\n"
+		"    if { [string range $key 2 end] != \"FFF\" &amp;&amp;\n"
+		"         [get_mapper_size [string index $key 0] [string index $key 1]] == 0 } {\n"
+		"      set first [expr {$page * 0x4000}]\n"
+		"      lappend ::debug_coverage_rom_ids [debug set_watchpoint write_mem "
+		"[list $first [expr {$first + 0x3FFF}]] {} debug_hook_coverage_remap]\n"
+		"    }\n"
+		"  }\n"
+		"}\n"
+		"proc debug_hook_coverage { } {\n"
+		"  if { $::debug_coverage_dirty } { debug_coverage_keys }\n"
+		"  set pc [reg PC]\n"
+		"  set key $::debug_coverage_key([expr {$pc &gt;&gt; 13}])\n"
+		"  if { ![info exists ::debug_coverage_seen($pc,$key)] } {\n"
+		"    set ::debug_coverage_seen($pc,$key) 1\n"
+		"    append ::debug_coverage_new [format %04X $pc] $key\n"
+		"  }\n"
+		"  return 0\n"
+		"}\n"));
+
+	// every fetch refreshes the keys too, that catches what the
+	// watchpoints don't see, like loading a savestate
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_coverage_fetch { } {\n"
+		"  set result $::debug_coverage_new\n"
+		"  set ::debug_coverage_new \"\"\n"
+		"  set ::debug_coverage_dirty 1\n"
+		"  return $result\n"
+		"}\n"));
+
+	// the hook never returns true, so the condition doesn't break
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"array unset ::debug_coverage_seen\n"
+		"set ::debug_coverage_new \"\"\n"
+		"set ::debug_coverage_dirty 1\n"
+		"set ::debug_coverage_rom_ids [list]\n"
+		"set ::debug_coverage_ids [list "
+		"[debug set_watchpoint write_io 0xA8 {} debug_hook_coverage_remap] "
+		"[debug set_watchpoint write_io {0xFC 0xFF} {} debug_hook_coverage_remap] "
+		"[debug set_watchpoint write_mem 0xFFFF {} debug_hook_coverage_remap]]\n"
+		"set ::debug_coverage_id [debug set_condition {[debug_hook_coverage]}]"));
+
+	running = true;
+	fetchTimer.start();
+	emit runningChanged(true);
+}
+
+void CoverageCollector::stop()
+{
+	if (!running) return;
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"debug remove_condition $::debug_coverage_id\n"
+		"foreach id [concat $::debug_coverage_ids $::debug_coverage_rom_ids] {\n"
+		"  debug remove_watchpoint $id\n"
+		"}"));
+	// collect what was executed since the last fetch, even when a
+	// periodic fetch is still underway
+	fetcher.fetchNow();
+	running = false;
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void CoverageCollector::clear()
+{
+	coverage.clear();
+	resync();
+	emit coverageChanged();
+}
+
+void CoverageCollector::resync()
+{
+	if (running) {
+		// the map was replaced, report everything again from now on
+		CommClient::instance().sendCommand(new SimpleCommand(
+			"array unset ::debug_coverage_seen\n"
+			"set ::debug_coverage_new \"\""));
+	}
+}
+
+void CoverageCollector::fetch()
+{
+	if (!running) return;
+	fetcher.fetch();
+}
+
+void CoverageCollector::connectionClosed()
+{
+	if (!running) return;
+	running = false;
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void CoverageCollector::addAddresses(const QString& data)
+{
+	int count = data.size() / ENTRY_LENGTH;
+	if (count == 0) return;
+
+	QByteArray bytes = data.toLatin1();
+	const char* p = bytes.constData();
+	for (int i = 0; i < count; ++i, p += ENTRY_LENGTH) {
+		int addr = 0;
+		for (int j = 0; j < 4; ++j) {
+			addr = (addr << 4) | hexDigitValue(p[j]);
+		}
+		int seg = 0;
+		for (int j = 6; j < 9; ++j) {
+			seg = (seg << 4) | hexDigitValue(p[j]);
+		}
+		coverage.mark(makeSlotKey(hexDigitValue(p[4]), hexDigitValue(p[5]), seg), addr);
+	}
+	emit coverageChanged();
+}
@@ -0,0 +1,47 @@
+#ifndef COVERAGECOLLECTOR_H
+#define COVERAGECOLLECTOR_H
+
+#include "OpenMSXConnection.h"
+#include <QObject>
+#include <QTimer>
+
+class CoverageMap;
+
+/** Records which instructions are executed.
+  * A condition in openMSX calls a hook for every instruction; the hook
+  * only remembers addresses that weren't seen before in their slot and
+  * segment, so the debugger fetches just the new ones and the emulation
+  * never stops for it.
+  */
+class CoverageCollector : public QObject
+{
+	Q_OBJECT
+public:
+	CoverageCollector(CoverageMap& coverage, QObject* parent = 0);
+
+	bool isRunning() const;
+
+public slots:
+	void start();
+	void stop();
+	void clear();
+	void resync();
+	void fetch();
+
+signals:
+	void coverageChanged();
+	void runningChanged(bool running);
+
+private slots:
+	void connectionClosed();
+
+private:
+	void addAddresses(const QString& data);
+
+	CoverageMap& coverage;
+	bool running;
+	SingleFetch fetcher;
+	QTimer fetchTimer;
+};
+
+#endif // COVERAGECOLLECTOR_H
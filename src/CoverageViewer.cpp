@@ -0,0 +1,204 @@
+#include "CoverageViewer.h"
+#include "CoverageCollector.h"
+#include "DebuggerData.h"
+#include "SymbolTable.h"
+#include "Convert.h"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+
+CoverageViewer::CoverageViewer(QWidget* parent)
+	: QWidget(parent)
+{
+	recordButton = new QPushButton(tr("Record"));
+	recordButton->setCheckable(true);
+	clearButton = new QPushButton(tr("Clear"));
+	totalLabel = new QLabel();
+
+	segmentList = new QTreeWidget();
+	segmentList->setColumnCount(3);
+	segmentList->setHeaderLabels(QStringList() << tr("Slot / dead code candidate")
+	                                           << tr("Address") << tr("Executed"));
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->setMargin(0);
+	hbox->addWidget(recordButton);
+	hbox->addWidget(clearButton);
+	hbox->addStretch();
+	hbox->addWidget(totalLabel);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->setMargin(0);
+	vbox->addLayout(hbox);
+	vbox->addWidget(segmentList);
+	setLayout(vbox);
+
+	collector = 0;
+	coverage = 0;
+	symTable = 0;
+
+	connect(recordButton, SIGNAL(toggled(bool)), this, SLOT(startStop(bool)));
+	connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+	connect(segmentList, SIGNAL(itemActivated(QTreeWidgetItem*, int)),
+	        this, SLOT(itemActivated(QTreeWidgetItem*)));
+}
+
+void CoverageViewer::setCollector(CoverageCollector* c, CoverageMap* map)
+{
+	collector = c;
+	coverage = map;
+	connect(collector, SIGNAL(coverageChanged()), this, SLOT(refresh()));
+	connect(collector, SIGNAL(runningChanged(bool)), this, SLOT(runningChanged(bool)));
+	runningChanged(collector->isRunning());
+}
+
+void CoverageViewer::setSymbolTable(SymbolTable* st)
+{
+	symTable = st;
+	symbolsChanged();
+}
+
+void CoverageViewer::symbolsChanged()
+{
+	// every slot has to check the new labels
+	for (QHash<int, QTreeWidgetItem*>::iterator it = slotItems.begin();
+	     it != slotItems.end(); ++it) {
+		it.value()->setData(2, Qt::UserRole, -1);
+	}
+	refresh();
+}
+
+void CoverageViewer::showEvent(QShowEvent* e)
+{
+	QWidget::showEvent(e);
+	refresh();
+}
+
+void CoverageViewer::startStop(bool checked)
+{
+	if (!collector || checked == collector->isRunning()) return;
+	if (checked) {
+		collector->start();
+	} else {
+		collector->stop();
+	}
+}
+
+void CoverageViewer::runningChanged(bool running)
+{
+	recordButton->setChecked(running);
+}
+
+void CoverageViewer::clear()
+{
+	if (collector) collector->clear();
+}
+
+static QString slotName(int slotKey)
+{
+	int ps = slotKey & 3;
+	int ss = (slotKey >> 2) & 3;
+	int segment = slotKey >> 4;
+	QString name = QString("Slot %1-%2").arg(ps).arg(ss);
+	if (segment != 0xFFF) {
+		name += QString(", segment %1").arg(segment);
+	}
+	return name;
+}
+
+void CoverageViewer::refresh()
+{
+	if (!coverage) return;
+
+	QList<int> keys = coverage->slotKeys();
+	std::sort(keys.begin(), keys.end());
+
+	int total = 0;
+	for (int i = 0; i < keys.size(); ++i) {
+		total += coverage->coveredCount(keys[i]);
+	}
+	totalLabel->setText(tr("%1 addresses in %2 slots/segments")
+	                    .arg(total).arg(keys.size()));
+
+	// updating the list is only needed when someone looks at it
+	if (!isVisible()) return;
+
+	// the slots that are gone, after clearing the coverage
+	for (QHash<int, QTreeWidgetItem*>::iterator it = slotItems.begin();
+	     it != slotItems.end(); ) {
+		if (std::binary_search(keys.begin(), keys.end(), it.key())) {
+			++it;
+		} else {
+			delete it.value();
+			it = slotItems.erase(it);
+		}
+	}
+
+	// the keys are sorted, so is the list
+	QList<int> changed;
+	for (int i = 0; i < keys.size(); ++i) {
+		int key = keys[i];
+		QTreeWidgetItem* item = slotItems.value(key);
+		if (!item) {
+			item = new QTreeWidgetItem();
+			item->setText(0, slotName(key));
+			item->setData(0, Qt::UserRole, -1);
+			item->setData(2, Qt::UserRole, -1);
+			segmentList->insertTopLevelItem(i, item);
+			slotItems.insert(key, item);
+		}
+		if (item->data(2, Qt::UserRole).toInt() != coverage->coveredCount(key)) {
+			changed.append(key);
+		}
+	}
+	if (changed.isEmpty()) return;
+
+	QList<Symbol*> labels;
+	if (symTable) {
+		for (SymbolTable::AddressIterator it = symTable->addressSymbols();
+		     !it.atEnd(); ++it) {
+			Symbol* s = *it;
+			if (s->type() == Symbol::JUMPLABEL && s->status() == Symbol::ACTIVE) {
+				labels.append(s);
+			}
+		}
+	}
+	for (int i = 0; i < changed.size(); ++i) {
+		int key = changed[i];
+		updateSlot(slotItems.value(key), key, coverage->coveredCount(key), labels);
+	}
+}
+
+void CoverageViewer::updateSlot(QTreeWidgetItem* item, int key, int count,
+                                const QList<Symbol*>& labels)
+{
+	item->setText(2, QString::number(count));
+	item->setData(2, Qt::UserRole, count);
+	qDeleteAll(item->takeChildren());
+
+	// labels in code of this slot and segment that ran, but that were
+	// never executed themselves, are candidates for dead code
+	int slotBit = 1 << (4 * (key & 3) + ((key >> 2) & 3));
+	int segment = key >> 4;
+	for (int j = 0; j < labels.size(); ++j) {
+		Symbol* s = labels[j];
+		if (!(s->validSlots() & slotBit)) continue;
+		// without a known segment, the label can't be ruled out
+		if (segment != 0xFFF && !s->isSegmentValid(segment)) continue;
+		if (!coverage->isBlockUsed(key, s->value())) continue;
+		if (coverage->isCovered(key, s->value())) continue;
+		QTreeWidgetItem* dead = new QTreeWidgetItem(item);
+		dead->setText(0, s->text());
+		dead->setText(1, hexValue(s->value(), 4).toUpper());
+		dead->setData(0, Qt::UserRole, s->value());
+	}
+}
+
+void CoverageViewer::itemActivated(QTreeWidgetItem* item)
+{
+	int addr = item->data(0, Qt::UserRole).toInt();
+	if (addr >= 0) emit jumpToAddress(addr);
+}
@@ -0,0 +1,58 @@
+#ifndef COVERAGEVIEWER_H
+#define COVERAGEVIEWER_H
+
+#include <QWidget>
+#include <QHash>
+#include <QList>
+
+class CoverageCollector;
+class CoverageMap;
+class SymbolTable;
+class Symbol;
+class QLabel;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+class CoverageViewer : public QWidget
+{
+	Q_OBJECT
+public:
+	CoverageViewer(QWidget* parent = 0);
+
+	void setCollector(CoverageCollector* c, CoverageMap* map);
+	void setSymbolTable(SymbolTable* st);
+
+public slots:
+	void refresh();
+	void symbolsChanged();
+
+private slots:
+	void startStop(bool checked);
+	void runningChanged(bool running);
+	void clear();
+	void itemActivated(QTreeWidgetItem* item);
+
+signals:
+	void jumpToAddress(quint16 addr);
+
+private:
+	void showEvent(QShowEvent* e);
+	void updateSlot(QTreeWidgetItem* item, int key, int count,
+	                const QList<Symbol*>& labels);
+
+	QPushButton* recordButton;
+	QPushButton* clearButton;
+	QLabel* totalLabel;
+	QTreeWidget* segmentList;
+
+	CoverageCollector* collector;
+	CoverageMap* coverage;
+	SymbolTable* symTable;
+
+	// the list item of every slot key, it's only updated when the
+	// number of covered addresses in that slot changed
+	QHash<int, QTreeWidgetItem*> slotItems;
+};
+
+#endif // COVERAGEVIEWER_H
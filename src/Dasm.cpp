@@ -42,12 +42,12 @@ void dasm(const unsigned char* membuf, unsigned short startAddr,
 {
 	int pc = startAddr;
 	int labelCount = 0;
-	Symbol* symbol = symTable->findFirstAddressSymbol(pc, memLayout);
+	SymbolTable::AddressIterator symbol = symTable->addressSymbols(pc, memLayout);
 
 	disasm.clear();
 	while (pc <= int(endAddr)) {
 		// check for a label
-		while (symbol && symbol->value() == pc) {
+		while (!symbol.atEnd() && symbol->value() == pc) {
 			++labelCount;
 			DisasmRow destsym;
 			destsym.rowType = DisasmRow::LABEL;
@@ -56,7 +56,7 @@ void dasm(const unsigned char* membuf, unsigned short startAddr,
 			destsym.addr = pc;
 			destsym.instr = symbol->text().toStdString();
 			disasm.push_back(destsym);
-			symbol = symTable->findNextAddressSymbol(memLayout);
+			++symbol;
 		}
 
 		labelCount = 0;
@@ -154,7 +154,7 @@ void dasm(const unsigned char* membuf, unsigned short startAddr,
 
 		// handle overflow at end or label
 		int dataBytes = 0;
-		if (symbol && pc + dest.numBytes > symbol->value()) {
+		if (!symbol.atEnd() && pc + dest.numBytes > symbol->value()) {
 			dataBytes = symbol->value() - pc;
 		} else if (pc + dest.numBytes > endAddr) {
 			dataBytes = endAddr - pc;
@@ -37,19 +37,32 @@ SymbolTable& DebugSession::symbolTable()
 	return symTable;
 }
 
+CoverageMap& DebugSession::coverage()
+{
+	return cov;
+}
+
+SourceMap& DebugSession::sourceMap()
+{
+	return srcMap;
+}
+
 void DebugSession::clear()
 {
 	// clear everything
 	symTable.clear();
 	breaks.clear();
+	cov.clear();
+	srcMap.clear();
 	fileName.clear();
 	modified = false;
 }
 
 void DebugSession::open(const QString& file)
 {
+	// not in text mode, the symbol range in the cache counts bytes
 	QFile f(file);
-	if (!f.open(QFile::ReadOnly | QFile::Text)) {
+	if (!f.open(QFile::ReadOnly)) {
 		QMessageBox::warning(0, tr("Open session ..."),
 		                     tr("Cannot read file %1:\n%2.")
 		                        .arg(file)
@@ -57,10 +70,22 @@ void DebugSession::open(const QString& file)
 		return;
 	}
 
+	QByteArray data = f.readAll();
+	f.close();
+
 	// clear current project and start reading xml file
 	clear();
-	QXmlStreamReader ses;
-	ses.setDevice(&f);
+	// the symbols come from the binary cache when the session file
+	// hasn't changed since it was made, then the reader doesn't even get
+	// to see them
+	QString cacheFile = SymbolTable::cacheFileName(file);
+	qint64 start, end;
+	bool cached = symTable.loadCache(cacheFile, file, start, end);
+	if (cached && start >= 0 && start <= end && end <= data.size() &&
+	    data.mid(int(start), 8) == "<Symbols") {
+		data.remove(int(start), int(end - start));
+	}
+	QXmlStreamReader ses(data);
 	while (!ses.atEnd()) {
 		ses.readNext();
 		if (ses.isStartElement() && (ses.name() == "DebugSession")) {
@@ -72,9 +97,17 @@ void DebugSession::open(const QString& file)
 				// begin tag
 				if (ses.isStartElement()) {
 					if (ses.name() == "Symbols") {
-						symTable.loadSymbols(ses);
+						if (cached) {
+							skipUnknownElement(ses);
+						} else {
+							symTable.loadSymbols(ses);
+						}
 					} else if (ses.name() == "Breakpoints") {
 						breaks.loadBreakpoints(ses);
+					} else if (ses.name() == "Coverage") {
+						cov.loadCoverage(ses);
+					} else if (ses.name() == "SourceMap") {
+						srcMap.loadSourceMap(ses);
 					} else {
 						skipUnknownElement(ses);
 					}
@@ -83,6 +116,11 @@ void DebugSession::open(const QString& file)
 		}
 	}
 
+	if (!cached) {
+		if (!findSymbols(data, start, end)) start = end = -1;
+		symTable.saveCache(cacheFile, file, start, end);
+	}
+
 	fileName = file;
 	modified = false;
 }
@@ -96,6 +134,26 @@ void DebugSession::skipUnknownElement(QXmlStreamReader& ses)
 	}
 }
 
+// byte range of the Symbols element in a session file
+bool DebugSession::findSymbols(const QByteArray& data, qint64& start, qint64& end)
+{
+	// the text in the element can't hold a '<', so the first end tag is it
+	int from = data.indexOf("<Symbols");
+	if (from < 0) return false;
+	int close = data.indexOf('>', from);
+	if (close < 0) return false;
+	if (data[close - 1] == '/') {
+		// an empty table
+		end = close + 1;
+	} else {
+		int to = data.indexOf("</Symbols>", close);
+		if (to < 0) return false;
+		end = to + 10;
+	}
+	start = from;
+	return true;
+}
+
 bool DebugSession::save()
 {
 	return saveAs(fileName);
@@ -103,9 +161,10 @@ bool DebugSession::save()
 
 bool DebugSession::saveAs(const QString& newFileName)
 {
-	// open file for save
+	// open file for save, in binary mode so the bytes on disk are the
+	// ones the symbol range in the cache refers to
 	QFile file(newFileName);
-	if (!file.open(QFile::WriteOnly | QFile::Text)) {
+	if (!file.open(QFile::WriteOnly)) {
 		QMessageBox::warning(0, tr("Save session ..."),
 		                     tr("Cannot write file %1:\n%2.")
 		                      .arg(fileName)
@@ -114,8 +173,8 @@ bool DebugSession::saveAs(const QString& newFileName)
 	}
 
 	// start xml file
-	QXmlStreamWriter ses;
-	ses.setDevice(&file);
+	QByteArray data;
+	QXmlStreamWriter ses(&data);
 	ses.setAutoFormatting(true);
 	ses.writeDTD("<!DOCTYPE xomds>");
 	ses.writeStartElement("DebugSession");
@@ -131,8 +190,31 @@ bool DebugSession::saveAs(const QString& newFileName)
 	breaks.saveBreakpoints(ses);
 	ses.writeEndElement();
 
+	// write execution coverage
+	ses.writeStartElement("Coverage");
+	cov.saveCoverage(ses);
+	ses.writeEndElement();
+
+	// write source line info files
+	ses.writeStartElement("SourceMap");
+	srcMap.saveSourceMap(ses);
+	ses.writeEndElement();
+
 	// end
 	ses.writeEndDocument();
+	if (file.write(data) != data.size()) {
+		QMessageBox::warning(0, tr("Save session ..."),
+		                     tr("Cannot write file %1:\n%2.")
+		                      .arg(newFileName)
+		                      .arg(file.errorString()));
+		return false;
+	}
+	file.close();
+	// cache for the file as it is now
+	qint64 start, end;
+	if (!findSymbols(data, start, end)) start = end = -1;
+	symTable.saveCache(SymbolTable::cacheFileName(newFileName), newFileName,
+	                   start, end);
 	modified = false;
 	fileName = newFileName; // only set after successful save
 	return true;
@@ -3,6 +3,7 @@
 
 #include "DebuggerData.h"
 #include "SymbolTable.h"
+#include "SourceMap.h"
 #include <QObject>
 
 class QXmlStreamReader;
@@ -24,12 +25,17 @@ public:
 
 	Breakpoints& breakpoints();
 	SymbolTable& symbolTable();
+	CoverageMap& coverage();
+	SourceMap& sourceMap();
 
 private:
 	void skipUnknownElement(QXmlStreamReader& ses);
+	static bool findSymbols(const QByteArray& data, qint64& start, qint64& end);
 
 	Breakpoints breaks;
 	SymbolTable symTable;
+	CoverageMap cov;
+	SourceMap srcMap;
 	QString fileName;
 	bool modified;
 
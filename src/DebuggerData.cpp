@@ -2,6 +2,7 @@
 #include "Convert.h"
 #include <QStringList>
 #include <QDebug>
+#include <algorithm>
 // class MemoryLayout
 
 MemoryLayout::MemoryLayout()
@@ -15,6 +16,171 @@ MemoryLayout::MemoryLayout()
 			mapperSize[p][q] = 0;
 		}
 	}
+	for (int b = 0; b < 8; ++b) {
+		romBlock[b] = -1;
+	}
+}
+
+void MemoryLayout::addressSlot(int addr, int& ps, int& ss, int& segment) const
+{
+	int p = (addr & 0xC000) >> 14;
+	ps = primarySlot[p] & 3;
+	// figure out secondary slot
+	ss = isSubslotted[ps] ? secondarySlot[p] & 3 : -1;
+	// figure out (rom) mapper segment
+	segment = -1;
+	if (mapperSize[ps][ss==-1 ? 0 : ss] > 0)
+		segment = mapperSegment[p];
+	else {
+		int q = 2*p + ((addr & 0x2000) >> 13);
+		if (romBlock[q] >= 0)
+			segment = romBlock[q];
+	}
+}
+
+int MemoryLayout::slotKey(int addr) const
+{
+	int ps, ss, segment;
+	addressSlot(addr, ps, ss, segment);
+	return makeSlotKey(ps, ss, segment);
+}
+
+int makeSlotKey(int ps, int ss, int segment)
+{
+	return (ps & 3) | ((ss < 0 ? 0 : ss & 3) << 2) | ((segment & 0xFFF) << 4);
+}
+
+
+// class CoverageMap
+
+CoverageMap::CoverageMap()
+{
+}
+
+void CoverageMap::clear()
+{
+	bitmaps.clear();
+}
+
+bool CoverageMap::isEmpty() const
+{
+	return bitmaps.isEmpty();
+}
+
+void CoverageMap::mark(int slotKey, int addr)
+{
+	QByteArray& block = bitmaps[slotKey].blocks[(addr & 0xFFFF) / BLOCK_SIZE];
+	if (block.isEmpty()) block.fill(0, BLOCK_SIZE / 8);
+	int bit = addr & (BLOCK_SIZE - 1);
+	block[bit >> 3] = block[bit >> 3] | (1 << (bit & 7));
+}
+
+bool CoverageMap::isCovered(int slotKey, int addr) const
+{
+	QHash<int, Bitmap>::const_iterator it = bitmaps.find(slotKey);
+	if (it == bitmaps.end()) return false;
+	const QByteArray& block = it->blocks[(addr & 0xFFFF) / BLOCK_SIZE];
+	if (block.isEmpty()) return false;
+	int bit = addr & (BLOCK_SIZE - 1);
+	return block.at(bit >> 3) & (1 << (bit & 7));
+}
+
+bool CoverageMap::isCovered(int addr, const MemoryLayout* ml) const
+{
+	if (bitmaps.isEmpty() || !ml) return false;
+	return isCovered(ml->slotKey(addr), addr);
+}
+
+bool CoverageMap::isBlockUsed(int slotKey, int addr) const
+{
+	QHash<int, Bitmap>::const_iterator it = bitmaps.find(slotKey);
+	if (it == bitmaps.end()) return false;
+	return !it->blocks[(addr & 0xFFFF) / BLOCK_SIZE].isEmpty();
+}
+
+int CoverageMap::coveredCount(int slotKey) const
+{
+	QHash<int, Bitmap>::const_iterator it = bitmaps.find(slotKey);
+	if (it == bitmaps.end()) return 0;
+	int count = 0;
+	for (int b = 0; b < BLOCK_COUNT; ++b) {
+		const QByteArray& block = it->blocks[b];
+		for (int i = 0; i < block.size(); ++i) {
+			unsigned char c = block.at(i);
+			for (; c; c &= c - 1) ++count;
+		}
+	}
+	return count;
+}
+
+QList<int> CoverageMap::slotKeys() const
+{
+	return bitmaps.keys();
+}
+
+void CoverageMap::merge(const CoverageMap& other)
+{
+	for (QHash<int, Bitmap>::const_iterator it = other.bitmaps.begin();
+	     it != other.bitmaps.end(); ++it) {
+		Bitmap& dest = bitmaps[it.key()];
+		for (int b = 0; b < BLOCK_COUNT; ++b) {
+			const QByteArray& src = it->blocks[b];
+			if (src.isEmpty()) continue;
+			if (dest.blocks[b].isEmpty()) {
+				// implicitly shared, no copy is made here
+				dest.blocks[b] = src;
+				continue;
+			}
+			char* d = dest.blocks[b].data();
+			for (int i = 0; i < src.size(); ++i) {
+				d[i] |= src.at(i);
+			}
+		}
+	}
+}
+
+void CoverageMap::saveCoverage(QXmlStreamWriter& xml)
+{
+	for (QHash<int, Bitmap>::const_iterator it = bitmaps.begin();
+	     it != bitmaps.end(); ++it) {
+		int ps = it.key() & 3;
+		int ss = (it.key() >> 2) & 3;
+		int segment = it.key() >> 4;
+		for (int b = 0; b < BLOCK_COUNT; ++b) {
+			if (it->blocks[b].isEmpty()) continue;
+			xml.writeStartElement("Block");
+			xml.writeAttribute("primarySlot", QString::number(ps));
+			xml.writeAttribute("secondarySlot", QString::number(ss));
+			xml.writeAttribute("segment", QString::number(segment == 0xFFF ? -1 : segment));
+			xml.writeAttribute("address", QString::number(b * BLOCK_SIZE));
+			xml.writeCharacters(it->blocks[b].toBase64());
+			xml.writeEndElement();
+		}
+	}
+}
+
+void CoverageMap::loadCoverage(QXmlStreamReader& xml)
+{
+	// loaded blocks are merged so coverage of several runs can be combined
+	while (!xml.atEnd()) {
+		xml.readNext();
+		// exit if closing of main tag
+		if (xml.isEndElement() && xml.name() == "Coverage") break;
+		// begin tag
+		if (xml.isStartElement() && xml.name() == "Block") {
+			int ps = xml.attributes().value("primarySlot").toString().toInt();
+			int ss = xml.attributes().value("secondarySlot").toString().toInt();
+			int segment = xml.attributes().value("segment").toString().toInt();
+			int addr = xml.attributes().value("address").toString().toInt();
+			QByteArray data = QByteArray::fromBase64(xml.readElementText().toLatin1());
+			if (data.size() != BLOCK_SIZE / 8) continue;
+
+			CoverageMap block;
+			block.bitmaps[makeSlotKey(ps, ss, segment)]
+				.blocks[(addr & 0xFFFF) / BLOCK_SIZE] = data;
+			merge(block);
+		}
+	}
 }
 
 
@@ -26,22 +192,57 @@ static const char *BreakpointSetCodes[] = {
 	"set_watchpoint write_mem",
 	"set_watchpoint read_io",
 	"set_watchpoint write_io",
-	"set_condition"
+	"set_condition",
+	"set_bp"
 };
 
-static QString getNextArgument(QString& data, int& pos)
+// prefix of the ids of breakpoints not yet confirmed by openMSX
+static const char* const PENDING_ID = "pending#";
+
+static void skipSpaces(const QString& data, int& pos, int end)
 {
-	QString result;
-	while (data[pos] == ' ' || data[pos] == '\t') ++pos;
-	while (true) {
-		if (data[pos] == ' ' || data[pos] == '\t') break;
-		if (data[pos] == '}' || data[pos] == ']') break;
-		result += data[pos];
+	while (pos < end && (data[pos] == ' ' || data[pos] == '\t')) ++pos;
+}
+
+static QStringRef getNextArgument(const QString& data, int& pos, int end)
+{
+	skipSpaces(data, pos, end);
+	int start = pos;
+	while (pos < end) {
+		QChar c = data[pos];
+		if (c == ' ' || c == '\t' || c == '}' || c == ']') break;
 		++pos;
 	}
-	return result;
+	return data.midRef(start, pos - start);
 }
 
+static bool skipToken(const QString& data, int& pos, const char* token)
+{
+	skipSpaces(data, pos, data.size());
+	QLatin1String t(token);
+	if (data.midRef(pos, t.size()) != t) return false;
+	pos += t.size();
+	return true;
+}
+
+// parses a slot or segment number of at most maxDigits digits, 'X' means
+// any and yields -1, -2 is returned when there is no number
+static int getSlotArgument(const QString& data, int& pos, int maxDigits)
+{
+	skipSpaces(data, pos, data.size());
+	if (pos < data.size() && data[pos] == 'X') {
+		++pos;
+		return -1;
+	}
+	int value = 0;
+	int digits = 0;
+	while (pos < data.size() && data[pos].isDigit()) {
+		if (++digits > maxDigits) return -2;
+		value = 10 * value + data[pos].digitValue();
+		++pos;
+	}
+	return digits ? value : -2;
+}
 
 bool Breakpoints::Breakpoint::operator==(const Breakpoint &bp) const
 {
@@ -60,27 +261,73 @@ bool Breakpoints::Breakpoint::operator==(const Breakpoint &bp) const
 		if (bp.ps != ps || bp.ss != ss || bp.segment != segment) return false;
 	}
 	// compare condition
-	return bp.condition == condition;
+	return bp.condition == condition && bp.log == log;
+}
+
+uint Breakpoints::Breakpoint::hash() const
+{
+	uint h = (qHash(condition) * 31 + qHash(log)) * 31 + type;
+	if (type != CONDITION) {
+		h = h * 31 + address;
+		if (type != BREAKPOINT && regionEnd != address) {
+			h = h * 31 + regionEnd;
+		}
+		h = h * 31 + uint(ps + 1);
+		h = h * 31 + uint(ss + 1);
+		h = h * 31 + uint(segment + 1);
+	}
+	return h;
 }
 
 
 Breakpoints::Breakpoints()
 	: memLayout(NULL)
+	, listVersion(-1)
+	, listGeneration(0)
+	, pendingCount(0)
+	, breakMap(0x10000)
+	, watchMap(0x10000)
+	, traceMap(0x10000)
+	, mapsValid(true)
 {
 }
 
 void Breakpoints::clear()
 {
 	breakpoints.clear();
+	listVersion = -1;
+	++listGeneration;
+	mapsValid = false;
+}
+
+int Breakpoints::version() const
+{
+	return listVersion;
+}
+
+void Breakpoints::setVersion(int v)
+{
+	listVersion = v;
+}
+
+int Breakpoints::generation() const
+{
+	return listGeneration;
 }
 
 void Breakpoints::setMemoryLayout(MemoryLayout* ml)
 {
 	memLayout = ml;
+	mapsValid = false;
+}
+
+void Breakpoints::layoutChanged()
+{
+	mapsValid = false;
 }
 
 QString Breakpoints::createSetCommand(Type type, int address, char ps, char ss, int segment, 
-                                      int endRange, QString condition)
+                                      int endRange, QString condition, QString log)
 {
 	QString cmd("debug %1 %2 %3");
 	QString addr, cond;
@@ -104,6 +351,11 @@ QString Breakpoints::createSetCommand(Type type, int address, char ps, char ss,
 		       .arg(condition.isEmpty() ? QString() : QString("&& ( %1 ) ").arg(condition));
 	}
 
+	// tracepoints log instead of doing the default 'debug break'
+	if (type == TRACEPOINT) {
+		cond += QString(" {debug_tracepoint {%1}}").arg(log);
+	}
+
 	return cmd.arg(BreakpointSetCodes[type])
 	          .arg(addr)
 	          .arg(escapeXML(cond));
@@ -123,40 +375,53 @@ QString Breakpoints::createRemoveCommand(const QString& id)
 	return cmd;
 }
 
+QString Breakpoints::createBatchCommand(const QStringList& commands)
+{
+	if (commands.size() == 1) return commands.first();
+	return "list [" + commands.join("] [") + "]";
+}
+
 void Breakpoints::setBreakpoints(const QString& str)
 {
 	breakpoints.clear();
-	QStringList bps = str.split('\n');
-	for (QStringList::Iterator it = bps.begin(); it != bps.end(); ++it) {
-		if ( it->trimmed().isEmpty() ) continue;
+	++listGeneration;
+	mapsValid = false;
+
+	// walk the lines in place, only the condition is copied
+	int lineStart = 0;
+	while (lineStart < str.size()) {
+		int end = str.indexOf('\n', lineStart);
+		if (end == -1) end = str.size();
+		int p = lineStart;
+		lineStart = end + 1;
 
 		Breakpoint newBp;
 
 		// set id
-		int p = 0;
-		newBp.id = getNextArgument(*it, p);
+		QStringRef id = getNextArgument(str, p, end);
+		if (id.isEmpty()) continue;
 
 		// determine type
-		if( it->startsWith("bp#") )
+		if (id.startsWith(QLatin1String("bp#"))) {
 
 			newBp.type = BREAKPOINT;
 
-		else if( it->startsWith("wp#") ) {
+		} else if (id.startsWith(QLatin1String("wp#"))) {
 
 			// determine watchpoint type
-			QString wptype = getNextArgument(*it, p);
-			if(wptype == "read_mem")
+			QStringRef wptype = getNextArgument(str, p, end);
+			if (wptype == QLatin1String("read_mem"))
 				newBp.type = WATCHPOINT_MEMREAD;
-			else if(wptype == "write_mem")
+			else if (wptype == QLatin1String("write_mem"))
 				newBp.type = WATCHPOINT_MEMWRITE;
-			else if(wptype == "read_io")
+			else if (wptype == QLatin1String("read_io"))
 				newBp.type = WATCHPOINT_IOREAD;
-			else if(wptype == "write_io")
+			else if (wptype == QLatin1String("write_io"))
 				newBp.type = WATCHPOINT_IOWRITE;
 			else //unknown
 				continue;
 
-		} else if( it->startsWith("cond#") ) {
+		} else if (id.startsWith(QLatin1String("cond#"))) {
 
 			newBp.type = CONDITION;
 
@@ -164,28 +429,42 @@ void Breakpoints::setBreakpoints(const QString& str)
 			// unknown
 			continue;
 		}
-		
+		newBp.id = id.toString();
+
 		// get address
 		p++;
-		if( newBp.type != CONDITION ) {
-			if ((*it)[p] == '{') {
+		if (newBp.type != CONDITION) {
+			if (p < end && str[p] == '{') {
 				p++;
-				newBp.address = stringToValue(getNextArgument(*it, p));
-				int q = it->indexOf('}', p);
-				newBp.regionEnd = stringToValue(it->mid(p, q-p));
+				newBp.address = stringToValue(getNextArgument(str, p, end).toString());
+				int q = str.indexOf('}', p);
+				if (q == -1 || q > end) continue;
+				newBp.regionEnd = stringToValue(str.mid(p, q-p));
 				p = q+1;
 			} else {
-				newBp.address = stringToValue(getNextArgument(*it, p));
+				newBp.address = stringToValue(getNextArgument(str, p, end).toString());
 				newBp.regionEnd = newBp.address;
 			}
 		} else
 			newBp.address = -1;
 
 		// check and clip command (skip non-default commands)
-		int q = it->lastIndexOf('{');
-		if (it->mid(q).simplified() != "{debug break}") continue;
+		int q = str.lastIndexOf(QLatin1String("{debug_tracepoint "), end - 1);
+		if (newBp.type == BREAKPOINT && q >= p) {
+			// {debug_tracepoint {message}}
+			int b = str.indexOf('{', q + 1);
+			int e = str.lastIndexOf('}', str.lastIndexOf('}', end - 1) - 1);
+			if (b == -1 || b >= end || e < b) continue;
+			newBp.type = TRACEPOINT;
+			newBp.log = str.mid(b + 1, e - b - 1).trimmed();
+			unescapeXML(newBp.log);
+		} else {
+			q = str.lastIndexOf('{', end - 1);
+			if (q < p) continue;
+			if (str.midRef(q, end - q).trimmed() != QLatin1String("{debug break}")) continue;
+		}
 
-		newBp.condition = it->mid(p, q-p).simplified();
+		newBp.condition = str.mid(p, q-p).simplified();
 		unescapeXML(newBp.condition);
 		parseCondition(newBp);
 		insertBreakpoint(newBp);
@@ -198,22 +477,31 @@ QString Breakpoints::mergeBreakpoints(const QString& str)
 	BreakpointList oldBps(breakpoints);
 	// parse new list
 	setBreakpoints(str);
+	// index the new list on content
+	QMultiHash<uint, const Breakpoint*> present;
+	for (BreakpointList::const_iterator it = breakpoints.constBegin();
+	     it != breakpoints.constEnd(); ++it) {
+		present.insert(it->hash(), &*it);
+	}
 	// check old list against new one
 	QStringList mergeSet;
-	while (!oldBps.empty()) {
-		Breakpoint& old = oldBps.first();
-		BreakpointList::iterator newit = breakpoints.begin();
-		for (/**/; newit != breakpoints.end(); ++newit) {
-			// check for identical data
-			if (old  == *newit) break;
+	for (BreakpointList::const_iterator old = oldBps.constBegin();
+	     old != oldBps.constEnd(); ++old) {
+		uint h = old->hash();
+		bool found = false;
+		for (QMultiHash<uint, const Breakpoint*>::const_iterator it = present.constFind(h);
+		     it != present.constEnd() && it.key() == h; ++it) {
+			if (*it.value() == *old) {
+				found = true;
+				break;
+			}
 		}
-		if (newit == breakpoints.end()) {
+		if (!found) {
 			// create command to set this breakpoint again
-			QString cmd = createSetCommand(old.type, old.address, old.ps, old.ss, old.segment,
-			                               old.regionEnd, old.condition);
+			QString cmd = createSetCommand(old->type, old->address, old->ps, old->ss, old->segment,
+			                               old->regionEnd, old->condition, old->log);
 			mergeSet << cmd;
 		}
-		oldBps.removeFirst();
 	}
 	return mergeSet.join(" ; ");
 }
@@ -225,29 +513,46 @@ void Breakpoints::parseCondition(Breakpoint& bp)
 	bp.segment = -1;
 
 	// first split off braces
-	if (bp.condition[0] == '{' && bp.condition.endsWith('}')) {
-		
-		if (bp.type != CONDITION) {
-			// check for slot argument
-			QRegExp rx("^\\{\\s*\\[\\s*(pc|watch)_in_slot\\s([X0123])\\s([X0123])\\s(X|\\d{1,3})\\s*\\]\\s*(&&\\s*\\((.+)\\)\\s*)?\\}$");
-			if (rx.indexIn(bp.condition) == 0) {
-				bool ok;
-				bp.ps = rx.cap(2).toInt(&ok);
-				if (!ok) bp.ps = -1;
-				bp.ss = rx.cap(3).toInt(&ok);
-				if (!ok) bp.ss = -1;
-				bp.segment = rx.cap(4).toInt(&ok);
-				if (!ok) bp.segment = -1;
-				bp.condition = rx.cap(6).trimmed();
-			} else {
-				bp.condition.chop(1);
-				bp.condition = bp.condition.mid(1).trimmed();
+	QString& cond = bp.condition;
+	if (!cond.startsWith('{') || !cond.endsWith('}')) return;
+
+	if (bp.type != CONDITION) {
+		// check for the slot argument added by createSetCommand:
+		// { [ pc_in_slot P S SEG ] && ( condition ) }
+		int p = 1;
+		if (skipToken(cond, p, "[") &&
+		    (skipToken(cond, p, "pc_in_slot") || skipToken(cond, p, "watch_in_slot"))) {
+			int ps = getSlotArgument(cond, p, 1);
+			int ss = getSlotArgument(cond, p, 1);
+			int segment = getSlotArgument(cond, p, 3);
+			if (ps >= -1 && ps <= 3 && ss >= -1 && ss <= 3 && segment >= -1 &&
+			    skipToken(cond, p, "]")) {
+				int last = cond.size() - 1;
+				skipSpaces(cond, p, last);
+				if (p == last) {
+					bp.ps = ps;
+					bp.ss = ss;
+					bp.segment = segment;
+					cond.clear();
+					return;
+				}
+				int q = cond.lastIndexOf(')');
+				if (skipToken(cond, p, "&&") && skipToken(cond, p, "(") && q >= p) {
+					int r = q + 1;
+					skipSpaces(cond, r, last);
+					if (r == last) {
+						bp.ps = ps;
+						bp.ss = ss;
+						bp.segment = segment;
+						cond = cond.mid(p, q - p).trimmed();
+						return;
+					}
+				}
 			}
-		} else {
-			bp.condition.chop(1);
-			bp.condition = bp.condition.mid(1).trimmed();
 		}
-	}	
+	}
+	cond.chop(1);
+	cond = cond.mid(1).trimmed();
 }
 
 bool Breakpoints::inCurrentSlot(const Breakpoint& bp)
@@ -278,15 +583,95 @@ bool Breakpoints::inCurrentSlot(const Breakpoint& bp)
 }
 
 void Breakpoints::insertBreakpoint(Breakpoint& bp)
+{
+	BreakpointList::iterator it = std::upper_bound(
+		breakpoints.begin(), breakpoints.end(), bp.address,
+		[](quint16 a, const Breakpoint& b) { return a < b.address; });
+	breakpoints.insert(it, bp);
+	mapsValid = false;
+}
+
+void Breakpoints::updateMaps()
+{
+	breakMap.fill(false);
+	watchMap.fill(false);
+	traceMap.fill(false);
+	for (BreakpointList::const_iterator it = breakpoints.constBegin();
+	     it != breakpoints.constEnd(); ++it) {
+		if (it->type == BREAKPOINT) {
+			if (inCurrentSlot(*it)) breakMap.setBit(it->address);
+		} else if (it->type == TRACEPOINT) {
+			if (inCurrentSlot(*it)) traceMap.setBit(it->address);
+		} else if (it->type == WATCHPOINT_MEMREAD || it->type == WATCHPOINT_MEMWRITE) {
+			if (inCurrentSlot(*it)) {
+				int end = std::max(it->address, it->regionEnd);
+				watchMap.fill(true, it->address, end + 1);
+			}
+		}
+	}
+	mapsValid = true;
+}
+
+QString Breakpoints::addBreakpoint(Type type, int address, char ps, char ss,
+                                   int segment, int endRange, const QString& condition,
+                                   const QString& log)
+{
+	// fill in the fields the way they are parsed back from openMSX
+	Breakpoint bp;
+	bp.type = type;
+	bp.id = QString("%1%2").arg(PENDING_ID).arg(++pendingCount);
+	bp.address = type == CONDITION ? -1 : address;
+	bp.regionEnd = (type > BREAKPOINT && type < CONDITION && endRange > address)
+	             ? endRange : bp.address;
+	bp.ps = type == CONDITION ? -1 : ps;
+	bp.ss = type == CONDITION ? -1 : ss;
+	bp.segment = type == CONDITION ? -1 : segment;
+	bp.condition = condition.simplified();
+	bp.log = type == TRACEPOINT ? log : QString();
+	insertBreakpoint(bp);
+	return bp.id;
+}
+
+bool Breakpoints::setBreakpointId(const QString& oldId, const QString& newId)
 {
 	for (BreakpointList::iterator it = breakpoints.begin();
 	     it != breakpoints.end(); ++it) {
-		if (it->address > bp.address) {
-			breakpoints.insert(it, bp);
-			return;
+		if (it->id == oldId) {
+			it->id = newId;
+			return true;
 		}
 	}
-	breakpoints.append(bp);
+	return false;
+}
+
+bool Breakpoints::removeBreakpoint(const QString& id)
+{
+	for (BreakpointList::iterator it = breakpoints.begin();
+	     it != breakpoints.end(); ++it) {
+		if (it->id == id) {
+			breakpoints.erase(it);
+			mapsValid = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+QStringList Breakpoints::breakpointIds(Type type, quint16 addr) const
+{
+	QStringList ids;
+	for (BreakpointList::const_iterator it = std::lower_bound(
+	         breakpoints.constBegin(), breakpoints.constEnd(), addr,
+	         [](const Breakpoint& b, quint16 a) { return b.address < a; });
+	     it != breakpoints.constEnd() && it->address == addr; ++it) {
+		if (it->type == type) ids << it->id;
+	}
+	return ids;
+}
+
+bool Breakpoints::isPendingId(const QString& id)
+{
+	return id.startsWith(QLatin1String(PENDING_ID));
 }
 
 int Breakpoints::breakpointCount()
@@ -296,33 +681,72 @@ int Breakpoints::breakpointCount()
 
 bool Breakpoints::isBreakpoint(quint16 addr, QString *id)
 {
-	for (BreakpointList::const_iterator it = breakpoints.constBegin();
-	     it != breakpoints.constEnd(); ++it) {
-		if (it->type == BREAKPOINT && it->address == addr) {
-			if (inCurrentSlot(*it)) {
-				if (id) *id = it->id;
-				return true;
+	if (!mapsValid) updateMaps();
+	if (!breakMap.testBit(addr)) return false;
+	if (id) {
+		// only the breakpoints at this address need to be checked
+		for (BreakpointList::const_iterator it = std::lower_bound(
+		         breakpoints.constBegin(), breakpoints.constEnd(), addr,
+		         [](const Breakpoint& b, quint16 a) { return b.address < a; });
+		     it != breakpoints.constEnd() && it->address == addr; ++it) {
+			if (it->type == BREAKPOINT && inCurrentSlot(*it)) {
+				*id = it->id;
+				break;
 			}
 		}
 	}
-	return false;
+	return true;
 }
 
 bool Breakpoints::isWatchpoint(quint16 addr, QString *id)
 {
+	if (!mapsValid) updateMaps();
+	if (!watchMap.testBit(addr)) return false;
+	if (id) {
+		// regions can start anywhere before addr, but there is a hit
+		for (BreakpointList::const_iterator it = breakpoints.constBegin();
+		     it != breakpoints.constEnd() && it->address <= addr; ++it) {
+			if (it->type != WATCHPOINT_MEMREAD && it->type != WATCHPOINT_MEMWRITE) continue;
+			if ((it->address == addr || addr <= it->regionEnd) && inCurrentSlot(*it)) {
+				*id = it->id;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+bool Breakpoints::isTracepoint(quint16 addr)
+{
+	if (!mapsValid) updateMaps();
+	return traceMap.testBit(addr);
+}
+
+QList<quint16> Breakpoints::tracepointAddresses() const
+{
+	QList<quint16> addrs;
 	for (BreakpointList::const_iterator it = breakpoints.constBegin();
 	     it != breakpoints.constEnd(); ++it) {
-		if (it->type == WATCHPOINT_MEMREAD || it->type == WATCHPOINT_MEMWRITE)
-			if ( (it->address == addr && it->regionEnd < it->address) ||
-			     (addr >= it->address && addr <= it->regionEnd) )
-			{
-				if (inCurrentSlot(*it)) {
-					if (id) *id = it->id;
-					return true;
-				}
-			}
+		if (it->type == TRACEPOINT &&
+		    (addrs.isEmpty() || addrs.last() != it->address)) {
+			addrs << it->address;
+		}
 	}
-	return false;
+	return addrs;
+}
+
+QList<quint16> Breakpoints::breakpointAddresses()
+{
+	if (!mapsValid) updateMaps();
+	QList<quint16> addrs;
+	for (BreakpointList::const_iterator it = breakpoints.constBegin();
+	     it != breakpoints.constEnd(); ++it) {
+		if (it->type == BREAKPOINT && breakMap.testBit(it->address) &&
+		    (addrs.isEmpty() || addrs.last() != it->address)) {
+			addrs << it->address;
+		}
+	}
+	return addrs;
 }
 
 int Breakpoints::findBreakpoint(quint16 addr)
@@ -367,6 +791,9 @@ void Breakpoints::saveBreakpoints(QXmlStreamWriter& xml)
 		case CONDITION:
 			xml.writeAttribute("type", "condition");
 			break;
+		case TRACEPOINT:
+			xml.writeAttribute("type", "tracepoint");
+			break;
 		}
 
 		// id
@@ -378,7 +805,7 @@ void Breakpoints::saveBreakpoints(QXmlStreamWriter& xml)
 		xml.writeAttribute("segment", QString::number(it->segment));
 
 		// address
-		if (it->type == BREAKPOINT) {
+		if (it->type == BREAKPOINT || it->type == TRACEPOINT) {
 			xml.writeTextElement("address", QString::number(it->address));
 		} else if (it->type != CONDITION) {
 			xml.writeTextElement("regionStart", QString::number(it->address));
@@ -388,6 +815,11 @@ void Breakpoints::saveBreakpoints(QXmlStreamWriter& xml)
 		// condition
 		xml.writeTextElement("condition", it->condition);
 
+		// tracepoint message
+		if (it->type == TRACEPOINT) {
+			xml.writeTextElement("log", it->log);
+		}
+
 		// complete
 		xml.writeEndElement();
 	}
@@ -421,12 +853,15 @@ void Breakpoints::loadBreakpoints(QXmlStreamReader& xml)
 					bp.type = WATCHPOINT_MEMWRITE;
 				} else if (type == "condition") {
 					bp.type = CONDITION;
+				} else if (type == "tracepoint") {
+					bp.type = TRACEPOINT;
 				} else {
 					bp.type = BREAKPOINT;
 				}
 
 				// id
 				bp.id = xml.attributes().value("id").toString();
+				bp.log.clear();
 
 				// slot/segment
 				char c = xml.attributes().value("primarySlot").at(0).toLatin1();
@@ -438,13 +873,15 @@ void Breakpoints::loadBreakpoints(QXmlStreamReader& xml)
 			} else if (xml.name() == "address" || xml.name() == "regionStart") {
 				// read symbol name
 				bp.address = xml.readElementText().toInt();
-				if (bp.type == BREAKPOINT) bp.regionEnd = bp.address;
+				if (bp.type == BREAKPOINT || bp.type == TRACEPOINT) bp.regionEnd = bp.address;
 
 			} else if (xml.name() == "regionEnd") {
 				// read symbol name
 				bp.regionEnd = xml.readElementText().toInt();
 			} else if (xml.name() == "condition") {
 				bp.condition = xml.readElementText().simplified();
+			} else if (xml.name() == "log") {
+				bp.log = xml.readElementText().trimmed();
 			}
 		}
 	}
@@ -1,8 +1,12 @@
 #ifndef DEBUGGERDATA_H
 #define DEBUGGERDATA_H
 
-#include <QLinkedList>
+#include <QList>
+#include <QBitArray>
+#include <QHash>
+#include <QByteArray>
 #include <QString>
+#include <QStringList>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -10,6 +14,12 @@ struct MemoryLayout
 {
 	MemoryLayout();
 
+	// slot, subslot and (mapper or rom) segment currently mapped at addr,
+	// -1 for a subslot or segment that doesn't apply
+	void addressSlot(int addr, int& ps, int& ss, int& segment) const;
+	// packed slot/segment key of the memory currently mapped at addr
+	int slotKey(int addr) const;
+
 	int primarySlot[4];
 	int secondarySlot[4];
 	int mapperSegment[4];
@@ -19,22 +29,93 @@ struct MemoryLayout
 	int mapperSize[4][4];
 };
 
+/** Packs a slot, subslot and segment in a 16 bit key. Subslot -1 is
+  * stored as 0 (it can't be confused since the primary slot isn't
+  * expanded then), segment -1 is stored as 0xFFF.
+  */
+int makeSlotKey(int ps, int ss, int segment);
+
+/** Set of executed addresses, one bit per address per slot/segment key.
+  * The bits are kept in 8kB blocks that are only allocated once an address
+  * inside them is marked, so tracking many megarom segments stays cheap.
+  */
+class CoverageMap
+{
+public:
+	CoverageMap();
+
+	void clear();
+	bool isEmpty() const;
+
+	void mark(int slotKey, int addr);
+	bool isCovered(int slotKey, int addr) const;
+	bool isCovered(int addr, const MemoryLayout* ml) const;
+	// true if anything in the 8kB block around addr was executed
+	bool isBlockUsed(int slotKey, int addr) const;
+	int coveredCount(int slotKey) const;
+	QList<int> slotKeys() const;
+
+	// add all addresses covered in other
+	void merge(const CoverageMap& other);
+
+	/* xml session file functions */
+	void saveCoverage(QXmlStreamWriter& xml);
+	void loadCoverage(QXmlStreamReader& xml);
+
+private:
+	enum { BLOCK_COUNT = 8, BLOCK_SIZE = 0x2000 };
+	struct Bitmap {
+		QByteArray blocks[BLOCK_COUNT];
+	};
+	QHash<int, Bitmap> bitmaps;
+};
+
 class Breakpoints
 {
 public:
 	Breakpoints();
 
+	// a tracepoint logs a message and continues instead of breaking
 	enum Type { BREAKPOINT = 0, WATCHPOINT_MEMREAD, WATCHPOINT_MEMWRITE,
-	            WATCHPOINT_IOREAD, WATCHPOINT_IOWRITE, CONDITION };
+	            WATCHPOINT_IOREAD, WATCHPOINT_IOWRITE, CONDITION, TRACEPOINT };
 
 	void clear();
 
 	void setMemoryLayout(MemoryLayout* ml);
+	// must be called when the slots or segments in the layout changed
+	void layoutChanged();
 	void setBreakpoints(const QString& str);
 	QString mergeBreakpoints(const QString& str);
+
+	/* Local changes are applied right away, before openMSX confirmed
+	 * them. A new breakpoint gets a pending id until openMSX assigned the
+	 * real one.
+	 */
+	QString addBreakpoint(Type type, int address, char ps = -1, char ss = -1,
+	                      int segment = -1, int endRange = -1,
+	                      const QString& condition = QString(),
+	                      const QString& log = QString());
+	// returns false when the pending id isn't in the list (any more)
+	bool setBreakpointId(const QString& oldId, const QString& newId);
+	bool removeBreakpoint(const QString& id);
+	static bool isPendingId(const QString& id);
+	// ids of all breakpoints of a type at an address, in any slot
+	QStringList breakpointIds(Type type, quint16 addr) const;
+
+	// version of the breakpoint list in openMSX that this list matches,
+	// -1 when unknown
+	int version() const;
+	void setVersion(int v);
+	// counts the times the whole list was replaced, which drops the local
+	// changes that openMSX didn't confirm yet
+	int generation() const;
 	int breakpointCount();
 	bool isBreakpoint(quint16 addr, QString *id = 0);
 	bool isWatchpoint(quint16 addr, QString *id = 0);
+	bool isTracepoint(quint16 addr);
+	QList<quint16> tracepointAddresses() const;
+	// addresses of the breakpoints in the slots that are mapped in, sorted
+	QList<quint16> breakpointAddresses();
 
 	/* xml session file functions */
 	void saveBreakpoints(QXmlStreamWriter& xml);
@@ -45,8 +126,11 @@ public:
 
 	static QString createSetCommand(Type type, int address, 
 	                                char ps = -1, char ss = -1, int segment = -1,
-	                                int endRange = -1, QString condition = QString());
+	                                int endRange = -1, QString condition = QString(),
+	                                QString log = QString());
 	static QString createRemoveCommand(const QString& id);
+	// combines commands in one, its result is the list of their results
+	static QString createBatchCommand(const QStringList& commands);
 
 private:
 	struct Breakpoint {
@@ -61,17 +145,33 @@ private:
 		qint16 segment;
 		// general condition
 		QString condition;
+		// message of a tracepoint
+		QString log;
 		// compare content
 		bool operator==(const Breakpoint &bp) const;
+		// hash of the content compared by operator==
+		uint hash() const;
 	};
-	typedef QLinkedList<Breakpoint> BreakpointList;
+	// sorted on address
+	typedef QList<Breakpoint> BreakpointList;
 
 	BreakpointList breakpoints;
 	MemoryLayout* memLayout;
+	int listVersion;
+	int listGeneration;
+	int pendingCount;
+
+	// addresses with a breakpoint or memory watchpoint that is active in
+	// the current memory layout, rebuilt when the list or the layout changes
+	QBitArray breakMap;
+	QBitArray watchMap;
+	QBitArray traceMap;
+	bool mapsValid;
 
 	void parseCondition(Breakpoint& bp);
 	void insertBreakpoint(Breakpoint& bp);
 	bool inCurrentSlot(const Breakpoint& bp);
+	void updateMaps();
 };
 
 #endif // DEBUGGERDATA_H
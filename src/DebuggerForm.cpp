@@ -1,10 +1,12 @@
 #include "DebuggerForm.h"
 #include "BitMapViewer.h"
+#include "TileViewer.h"
 #include "DockableWidgetArea.h"
 #include "DockableWidget.h"
 #include "DisasmViewer.h"
 #include "MainMemoryViewer.h"
 #include "CPURegsViewer.h"
+#include "CPURegs.h"
 #include "FlagsViewer.h"
 #include "StackViewer.h"
 #include "SlotViewer.h"
@@ -18,6 +20,18 @@
 #include "VDPRegViewer.h"
 #include "VDPStatusRegViewer.h"
 #include "VDPCommandRegViewer.h"
+#include "Profiler.h"
+#include "ProfilerViewer.h"
+#include "CoverageCollector.h"
+#include "CoverageViewer.h"
+#include "TraceBuffer.h"
+#include "TraceRecorder.h"
+#include "TraceViewer.h"
+#include "MemoryHeatmap.h"
+#include "HeatmapViewer.h"
+#include "TracepointLog.h"
+#include "TracepointViewer.h"
+#include "SourceViewer.h"
 #include "Settings.h"
 #include "Version.h"
 #include <QAction>
@@ -83,17 +97,27 @@ class ListBreakPointsHandler : public SimpleCommand
 {
 public:
 	ListBreakPointsHandler(DebuggerForm& form_, bool merge_ = false)
-		: SimpleCommand("debug_list_all_breaks")
+		: SimpleCommand(QString("debug_sync_breaks %1")
+		                .arg(merge_ ? -1 : form_.session.breakpoints().version()))
 		, form(form_), merge(merge_)
 	{
 	}
 
 	virtual void replyOk(const QString& message)
 	{
+		// only the version is returned when the list didn't change
+		int p = message.indexOf('\n');
+		if (p == -1) {
+			delete this;
+			return;
+		}
+		Breakpoints& bps = form.session.breakpoints();
+		QString list = message.mid(p + 1);
 		if (merge) {
-			QString bps = form.session.breakpoints().mergeBreakpoints(message);
-			if (!bps.isEmpty()) {
-				form.comm.sendCommand(new SimpleCommand(bps));
+			QString cmds = bps.mergeBreakpoints(list);
+			bps.setVersion(message.left(p).toInt());
+			if (!cmds.isEmpty()) {
+				form.comm.sendCommand(new SimpleCommand(cmds));
 				form.comm.sendCommand(new ListBreakPointsHandler(form, false));
 			} else {
 				form.disasmView->update();
@@ -101,7 +125,8 @@ public:
 				form.updateWindowTitle();
 			}
 		} else {
-			form.session.breakpoints().setBreakpoints(message);
+			bps.setBreakpoints(list);
+			bps.setVersion(message.left(p).toInt());
 			form.disasmView->update();
 			form.session.sessionModified();
 			form.updateWindowTitle();
@@ -114,6 +139,61 @@ private:
 };
 
 
+class BreakCommandHandler : public SimpleCommand
+{
+public:
+	// ids are the pending ids of the breakpoints created by the command,
+	// in the order of its results
+	BreakCommandHandler(DebuggerForm& form_, const QString& command,
+	                    const QStringList& ids_ = QStringList())
+		: SimpleCommand("debug_break_cmd {" + command + "}")
+		, form(form_), ids(ids_)
+		, sentVersion(form_.session.breakpoints().version())
+		, sentGeneration(form_.session.breakpoints().generation())
+	{
+	}
+
+	virtual void replyOk(const QString& message)
+	{
+		// reply is: <version before> <version after> <results>
+		Breakpoints& bps = form.session.breakpoints();
+		int p = message.indexOf(' ');
+		int q = message.indexOf(' ', p + 1);
+		if (q == -1) q = message.size();
+		// a list that arrived in between can have replaced the local change
+		bool inSync = bps.generation() == sentGeneration;
+		if (!ids.isEmpty()) {
+			QStringList newIds = message.mid(q + 1).split(' ', QString::SkipEmptyParts);
+			for (int i = 0; i < ids.size() && i < newIds.size(); ++i) {
+				if (!bps.setBreakpointId(ids[i], newIds[i])) inSync = false;
+			}
+		}
+		// the local list is still in sync if nothing else changed in between
+		int before = message.left(p).toInt();
+		if (inSync && before == sentVersion && before == bps.version()) {
+			bps.setVersion(message.mid(p + 1, q - p - 1).toInt());
+		} else if (!inSync) {
+			bps.setVersion(-1);
+			form.comm.sendCommand(new ListBreakPointsHandler(form));
+		}
+		delete this;
+	}
+
+	virtual void replyNok(const QString& message)
+	{
+		// the local change was wrong, get the real list instead
+		form.session.breakpoints().setVersion(-1);
+		form.comm.sendCommand(new ListBreakPointsHandler(form));
+		SimpleCommand::replyNok(message);
+	}
+private:
+	DebuggerForm& form;
+	QStringList ids;
+	int sentVersion;
+	int sentGeneration;
+};
+
+
 class CPURegRequest : public ReadDebugBlockCommand
 {
 public:
@@ -183,6 +263,12 @@ DebuggerForm::DebuggerForm(QWidget* parent)
 	VDPRegView = NULL;
 	VDPStatusRegView = NULL;
 	VDPCommandRegView = NULL;
+	profilerView = NULL;
+	coverageView = NULL;
+	traceView = NULL;
+	heatmapView = NULL;
+	tracepointView = NULL;
+	sourceView = NULL;
 
 	createActions();
 	createMenus();
@@ -194,6 +280,8 @@ DebuggerForm::DebuggerForm(QWidget* parent)
 	updateRecentFiles();
 	
 	connect(&session.symbolTable(), SIGNAL(symbolFileChanged()), this, SLOT(symbolFileChanged()));
+	connect(&session.symbolTable(), SIGNAL(symbolsReloaded(const QList<int>&, const QList<Symbol*>&, const QList<Symbol*>&)),
+	        disasmView, SLOT(labelsChanged(const QList<int>&)));
 }
 
 void DebuggerForm::createActions()
@@ -277,6 +365,30 @@ void DebuggerForm::createActions()
 	viewDebuggableViewerAction = new QAction(tr("Add debuggable viewer"), this);
 	viewDebuggableViewerAction->setStatusTip(tr("Add a hex viewer for debuggables"));
 
+	viewProfilerAction = new QAction(tr("Profiler"), this);
+	viewProfilerAction->setStatusTip(tr("Toggle the hot spot profiler display"));
+	viewProfilerAction->setCheckable(true);
+
+	viewCoverageAction = new QAction(tr("Code coverage"), this);
+	viewCoverageAction->setStatusTip(tr("Toggle the execution coverage display"));
+	viewCoverageAction->setCheckable(true);
+
+	viewTraceAction = new QAction(tr("Instruction trace"), this);
+	viewTraceAction->setStatusTip(tr("Toggle the instruction trace display"));
+	viewTraceAction->setCheckable(true);
+
+	viewHeatmapAction = new QAction(tr("Memory heatmap"), this);
+	viewHeatmapAction->setStatusTip(tr("Toggle the memory access heatmap display"));
+	viewHeatmapAction->setCheckable(true);
+
+	viewTracepointsAction = new QAction(tr("Tracepoints"), this);
+	viewTracepointsAction->setStatusTip(tr("Toggle the tracepoint log display"));
+	viewTracepointsAction->setCheckable(true);
+
+	viewSourceAction = new QAction(tr("Source"), this);
+	viewSourceAction->setStatusTip(tr("Toggle the source code display"));
+	viewSourceAction->setCheckable(true);
+
 	viewVDPStatusRegsAction = new QAction(tr("Status Registers"), this);
 	viewVDPStatusRegsAction->setStatusTip(tr("The VDP status registers interpreted"));
 	viewVDPStatusRegsAction->setCheckable(true);
@@ -289,6 +401,8 @@ void DebuggerForm::createActions()
 	viewBitMappedAction = new QAction(tr("Bitmapped VRAM"), this);
 	viewBitMappedAction->setStatusTip(tr("Decode VRAM as screen 5/6/7/8 image"));
 	//viewBitMappedAction->setCheckable(true);
+	viewTileAction = new QAction(tr("Tiles and sprites VRAM"), this);
+	viewTileAction->setStatusTip(tr("Show the patterns, name table and sprites of screen 0/1/2/3/4"));
 
 	executeBreakAction = new QAction(tr("Break"), this);
 	executeBreakAction->setShortcut(tr("CRTL+B"));
@@ -364,7 +478,14 @@ void DebuggerForm::createActions()
 	connect(viewSlotsAction, SIGNAL(triggered()), this, SLOT(toggleSlotsDisplay()));
 	connect(viewMemoryAction, SIGNAL(triggered()), this, SLOT(toggleMemoryDisplay()));
 	connect(viewDebuggableViewerAction, SIGNAL(triggered()), this, SLOT(addDebuggableViewer()));
+	connect(viewProfilerAction, SIGNAL(triggered()), this, SLOT(toggleProfilerDisplay()));
+	connect(viewCoverageAction, SIGNAL(triggered()), this, SLOT(toggleCoverageDisplay()));
+	connect(viewTraceAction, SIGNAL(triggered()), this, SLOT(toggleTraceDisplay()));
+	connect(viewHeatmapAction, SIGNAL(triggered()), this, SLOT(toggleHeatmapDisplay()));
+	connect(viewTracepointsAction, SIGNAL(triggered()), this, SLOT(toggleTracepointsDisplay()));
+	connect(viewSourceAction, SIGNAL(triggered()), this, SLOT(toggleSourceDisplay()));
 	connect(viewBitMappedAction, SIGNAL(triggered()), this, SLOT(toggleBitMappedDisplay()));
+	connect(viewTileAction, SIGNAL(triggered()), this, SLOT(toggleTileDisplay()));
 	connect(viewVDPRegsAction, SIGNAL(triggered()), this, SLOT(toggleVDPRegsDisplay()));
 	connect(viewVDPCommandRegsAction, SIGNAL(triggered()), this, SLOT(toggleVDPCommandRegsDisplay()));
 	connect(viewVDPStatusRegsAction, SIGNAL(triggered()), this, SLOT(toggleVDPStatusRegsDisplay()));
@@ -423,6 +544,13 @@ void DebuggerForm::createMenus()
 	viewVDPDialogsMenu = viewMenu->addMenu("VDP");
 	viewMenu->addSeparator();
 	viewMenu->addAction(viewDebuggableViewerAction);
+	viewMenu->addSeparator();
+	viewMenu->addAction(viewProfilerAction);
+	viewMenu->addAction(viewCoverageAction);
+	viewMenu->addAction(viewTraceAction);
+	viewMenu->addAction(viewHeatmapAction);
+	viewMenu->addAction(viewTracepointsAction);
+	viewMenu->addAction(viewSourceAction);
 	connect(viewMenu, SIGNAL(aboutToShow()), this, SLOT(updateViewMenu()));
 
 	// create VDP dialogs menu
@@ -430,6 +558,7 @@ void DebuggerForm::createMenus()
 	viewVDPDialogsMenu->addAction(viewVDPCommandRegsAction);
 	viewVDPDialogsMenu->addAction(viewVDPStatusRegsAction);
 	viewVDPDialogsMenu->addAction(viewBitMappedAction);
+	viewVDPDialogsMenu->addAction(viewTileAction);
 	connect(viewVDPDialogsMenu, SIGNAL(aboutToShow()), this, SLOT(updateVDPViewMenu()));
 
 
@@ -657,20 +786,44 @@ void DebuggerForm::createForm()
 	// added four bytes as runover buffer for dasm
 	// otherwise dasm would need to check the buffer end continously.
 	session.breakpoints().setMemoryLayout(&memLayout);
+	session.symbolTable().setMemoryLayout(&memLayout);
 	mainMemory = new unsigned char[65536 + 4];
 	memset(mainMemory, 0, 65536 + 4);
 	disasmView->setMemory(mainMemory);
 	disasmView->setBreakpoints(&session.breakpoints());
 	disasmView->setMemoryLayout(&memLayout);
 	disasmView->setSymbolTable(&session.symbolTable());
+	profiler = new Profiler(this);
+	disasmView->setProfiler(profiler);
+	coverageCollector = new CoverageCollector(session.coverage(), this);
+	disasmView->setCoverage(&session.coverage());
+	connect(coverageCollector, SIGNAL(coverageChanged()),
+	        this, SLOT(coverageChanged()));
+	connect(this, SIGNAL(emulationChanged()),
+	        coverageCollector, SLOT(fetch()));
+	traceBuffer = new TraceBuffer();
+	traceRecorder = new TraceRecorder(*traceBuffer, this);
+	connect(this, SIGNAL(emulationChanged()),
+	        traceRecorder, SLOT(fetch()));
+	heatmap = new MemoryHeatmap(this);
+	connect(this, SIGNAL(emulationChanged()),
+	        heatmap, SLOT(fetch()));
+	mainMemoryView->setHeatmap(heatmap);
+	tracepointLog = new TracepointLog(session.breakpoints(), this);
+	connect(this, SIGNAL(emulationChanged()),
+	        tracepointLog, SLOT(fetch()));
 	mainMemoryView->setDebuggable("memory", 65536);
+	mainMemoryView->setMemoryLayout(&memLayout);
 	stackView->setData(mainMemory, 65536);
 	slotView->setMemoryLayout(&memLayout);
+	connect(slotView, SIGNAL(memoryLayoutChanged()),
+	        this, SLOT(memoryLayoutChanged()));
 }
 
 DebuggerForm::~DebuggerForm()
 {
 	delete[] mainMemory;
+	delete traceBuffer;
 	delete mainArea;
 }
 
@@ -768,9 +921,13 @@ void DebuggerForm::initConnection()
 	comm.sendCommand(new QueryBreakedHandler(*this));
 
 	comm.sendCommand(new SimpleCommand("openmsx_update enable status"));
+	// machine changes, the VDP views cache what the machine has
+	comm.sendCommand(new SimpleCommand("openmsx_update enable hardware"));
 
 	comm.sendCommand(new ListDebuggablesHandler(*this));
 
+	tracepointLog->start();
+
 	// define 'debug_bin2hex' proc for internal use
 	comm.sendCommand(new SimpleCommand(
 		"proc debug_bin2hex { input } {\n"
@@ -831,15 +988,70 @@ void DebuggerForm::initConnection()
 		"  return $result\n"
 		"}\n"));
 
+	// define 'debug_slot_key' proc for internal use
+	// returns slot, subslot and segment of an address as 5 hex digits
+	comm.sendCommand(new SimpleCommand(
+		"array unset ::debug_romblocks\n"
+		"proc debug_slot_key { addr } {\n"
+		"  set page [expr {$addr &gt;&gt; 14}]\n"
+		"  set slot [get_selected_slot $page]\n"
+		"  set ps [lindex $slot 0]\n"
+		"  set ss [lindex $slot 1]\n"
+		"  if { $ss == \"X\" } { set ss 0 }\n"
+		"  set seg 4095\n"
+		"  if { [get_mapper_size $ps $ss] &gt; 0 } {\n"
+		"    set seg [debug read \"MapperIO\" $page]\n"
+		"  } else {\n"
+		"    set name \"[lindex [machine_info slot $ps $ss $page] 0] romblocks\"\n"
+		"    if { ![info exists ::debug_romblocks($name)] } {\n"
+		"      set ::debug_romblocks($name) [expr {[lsearch -exact [debug list] $name] != -1}]\n"
+		"    }\n"
+		"    if { $::debug_romblocks($name) } {\n"
+		"      set seg [debug read $name $addr]\n"
+		"    }\n"
+		"  }\n"
+		"  return [format %X%X%03X $ps $ss $seg]\n"
+		"}\n"));
+
 	// define 'debug_list_all_breaks' proc for internal use
+	// watchpoints and conditions that call the debugger's own hooks are left out
 	comm.sendCommand(new SimpleCommand(
 		"proc debug_list_all_breaks { } {\n"
 		"  set result [debug list_bp]\n"
-		"  append result [debug list_watchpoints]\n"
-		"  append result [debug list_conditions]\n"
+		"  set hooked [debug list_watchpoints]\n"
+		"  append hooked [debug list_conditions]\n"
+		"  foreach line [split $hooked \"\\n\"] {\n"
+		"    if { $line != \"\" &amp;&amp; [string first debug_hook_ $line] == -1 } {\n"
+		"      append result $line \"\\n\"\n"
+		"    }\n"
+		"  }\n"
 		"  return $result\n"
 		"}\n"));
-		
+
+	// define procs to only transfer the breakpoint list when it changed;
+	// every change bumps the version, also when made outside the debugger
+	comm.sendCommand(new SimpleCommand(
+		"set ::debug_breaks_known \"\"\n"
+		"set ::debug_breaks_version 0\n"
+		"proc debug_breaks_update { } {\n"
+		"  set current [debug_list_all_breaks]\n"
+		"  if { $current ne $::debug_breaks_known } {\n"
+		"    set ::debug_breaks_known $current\n"
+		"    incr ::debug_breaks_version\n"
+		"  }\n"
+		"}\n"
+		"proc debug_sync_breaks { version } {\n"
+		"  debug_breaks_update\n"
+		"  if { $version == $::debug_breaks_version } { return $version }\n"
+		"  return \"$::debug_breaks_version\\n$::debug_breaks_known\"\n"
+		"}\n"
+		"proc debug_break_cmd { cmd } {\n"
+		"  debug_breaks_update\n"
+		"  set before $::debug_breaks_version\n"
+		"  set result [eval $cmd]\n"
+		"  debug_breaks_update\n"
+		"  return \"$before $::debug_breaks_version $result\"\n"
+		"}\n"));
 }
 
 void DebuggerForm::connectionClosed()
@@ -974,6 +1186,9 @@ void DebuggerForm::fileNewSession()
 		}
 	}
 	session.clear();
+	coverageCollector->resync();
+	if (coverageView) coverageView->refresh();
+	if (sourceView) sourceView->refresh();
 	updateWindowTitle();
 }
 
@@ -991,6 +1206,10 @@ void DebuggerForm::openSession(const QString& file)
 {
 	fileNewSession();
 	session.open(file);
+	coverageCollector->resync();
+	if (coverageView) coverageView->refresh();
+	if (sourceView) sourceView->refresh();
+	disasmView->update();
 	if (systemDisconnectAction->isEnabled()) {
 		// active connection, merge loaded breakpoints
 		comm.sendCommand(new ListBreakPointsHandler(*this, true));
@@ -1072,6 +1291,10 @@ void DebuggerForm::systemSymbolManager()
 	SymbolManager symManager(session.symbolTable(), this);
 	connect(&symManager, SIGNAL(symbolTableChanged()),
 	        &session, SLOT(sessionModified()));
+	connect(&symManager, SIGNAL(setBreakpoints(const QList<Symbol*>&)),
+	        this, SLOT(breakpointsAddSymbols(const QList<Symbol*>&)));
+	connect(&symManager, SIGNAL(removeBreakpoints(const QList<Symbol*>&)),
+	        this, SLOT(breakpointsRemoveSymbols(const QList<Symbol*>&)));
 	symManager.exec();
 	emit symbolsChanged();
 	updateWindowTitle();
@@ -1153,18 +1376,26 @@ void DebuggerForm::breakpointToggle(int addr)
 	// toggle address unspecified, use cursor address
 	if (addr < 0) addr = disasmView->cursorAddress();
 
+	Breakpoints& bps = session.breakpoints();
 	QString cmd, id;
-	if (session.breakpoints().isBreakpoint(addr, &id)) {
+	QStringList newIds;
+	if (bps.isBreakpoint(addr, &id)) {
+		// it can't be removed before openMSX told its id
+		if (Breakpoints::isPendingId(id)) return;
 		cmd = Breakpoints::createRemoveCommand(id);
+		bps.removeBreakpoint(id);
 	} else {
 		// get slot
 		int ps, ss, seg;
 		addressSlot(addr, ps, ss, seg);
 		// create command
 		cmd = Breakpoints::createSetCommand(Breakpoints::BREAKPOINT, addr, ps, ss, seg);
+		newIds << bps.addBreakpoint(Breakpoints::BREAKPOINT, addr, ps, ss, seg);
 	}
-	comm.sendCommand(new SimpleCommand(cmd));
-	comm.sendCommand(new ListBreakPointsHandler(*this));
+	comm.sendCommand(new BreakCommandHandler(*this, cmd, newIds));
+	disasmView->update();
+	session.sessionModified();
+	updateWindowTitle();
 }
 
 void DebuggerForm::breakpointAdd()
@@ -1178,11 +1409,70 @@ void DebuggerForm::breakpointAdd()
 		if (bpd.address() >= 0) {
 			QString cmd = Breakpoints::createSetCommand(
 				bpd.type(), bpd.address(), bpd.slot(), bpd.subslot(), bpd.segment(),
-				bpd.addressEndRange(), bpd.condition() );
-			comm.sendCommand(new SimpleCommand(cmd));
-			comm.sendCommand(new ListBreakPointsHandler(*this));
+				bpd.addressEndRange(), bpd.condition(), bpd.logMessage() );
+			QString id = session.breakpoints().addBreakpoint(
+				bpd.type(), bpd.address(), bpd.slot(), bpd.subslot(), bpd.segment(),
+				bpd.addressEndRange(), bpd.condition(), bpd.logMessage() );
+			comm.sendCommand(new BreakCommandHandler(*this, cmd, QStringList(id)));
+			disasmView->update();
+			session.sessionModified();
+			updateWindowTitle();
+		}
+	}
+}
+
+void DebuggerForm::breakpointsAddSymbols(const QList<Symbol*>& symbols)
+{
+	Breakpoints& bps = session.breakpoints();
+	QStringList cmds, ids;
+	for (QList<Symbol*>::const_iterator it = symbols.begin(); it != symbols.end(); ++it) {
+		int addr = (*it)->value();
+		if (!bps.breakpointIds(Breakpoints::BREAKPOINT, addr).isEmpty()) continue;
+		int valid = (*it)->validSlots();
+		if (valid == 0xFFFF) {
+			cmds << Breakpoints::createSetCommand(Breakpoints::BREAKPOINT, addr);
+			ids << bps.addBreakpoint(Breakpoints::BREAKPOINT, addr);
+			continue;
+		}
+		// one breakpoint per slot the symbol is valid in
+		for (int ps = 0; ps < 4; ++ps) {
+			int subslots = (valid >> (4 * ps)) & 15;
+			for (int ss = 0; ss < 4; ++ss) {
+				if (!(subslots & (1 << ss))) continue;
+				// no need to check the subslot when all of them are valid
+				int s = subslots == 15 ? -1 : ss;
+				cmds << Breakpoints::createSetCommand(Breakpoints::BREAKPOINT, addr, ps, s);
+				ids << bps.addBreakpoint(Breakpoints::BREAKPOINT, addr, ps, s);
+				if (s == -1) break;
+			}
+		}
+	}
+	if (cmds.isEmpty()) return;
+	comm.sendCommand(new BreakCommandHandler(
+		*this, Breakpoints::createBatchCommand(cmds), ids));
+	disasmView->update();
+	session.sessionModified();
+	updateWindowTitle();
+}
+
+void DebuggerForm::breakpointsRemoveSymbols(const QList<Symbol*>& symbols)
+{
+	Breakpoints& bps = session.breakpoints();
+	QStringList cmds;
+	for (QList<Symbol*>::const_iterator it = symbols.begin(); it != symbols.end(); ++it) {
+		QStringList ids = bps.breakpointIds(Breakpoints::BREAKPOINT, (*it)->value());
+		for (QStringList::const_iterator id = ids.begin(); id != ids.end(); ++id) {
+			// pending breakpoints are left alone, like when toggling
+			if (Breakpoints::isPendingId(*id)) continue;
+			cmds << Breakpoints::createRemoveCommand(*id);
+			bps.removeBreakpoint(*id);
 		}
 	}
+	if (cmds.isEmpty()) return;
+	comm.sendCommand(new BreakCommandHandler(*this, Breakpoints::createBatchCommand(cmds)));
+	disasmView->update();
+	session.sessionModified();
+	updateWindowTitle();
 }
 
 void DebuggerForm::showAbout()
@@ -1242,6 +1532,22 @@ void DebuggerForm::toggleBitMappedDisplay()
 	*/
 }
 
+void DebuggerForm::toggleTileDisplay()
+{
+	// like the bitmap viewer, every call opens another viewer
+	TileViewer* viewer = new TileViewer();
+	DockableWidget* dw = new DockableWidget(dockMan);
+	dw->setWidget(viewer);
+	dw->setTitle(tr("Tiles and Sprites VRAM View"));
+	dw->setId("TILEVRAMVIEW");
+	dw->setFloating(true);
+	dw->setDestroyable(true);
+	dw->setMovable(true);
+	dw->setClosable(true);
+
+	connect(this, SIGNAL(emulationChanged()), viewer, SLOT(refresh()));
+}
+
 void DebuggerForm::toggleVDPCommandRegsDisplay()
 {
 	if (VDPCommandRegView == NULL) {
@@ -1261,6 +1567,208 @@ void DebuggerForm::toggleVDPCommandRegsDisplay()
 	}
 }
 
+void DebuggerForm::toggleProfilerDisplay()
+{
+	if (profilerView == NULL) {
+		profilerView = new ProfilerViewer();
+		profilerView->setProfiler(profiler);
+		profilerView->setSymbolTable(&session.symbolTable());
+		profilerView->setMemory(mainMemory);
+		profilerView->setMemoryLayout(&memLayout);
+		DockableWidget* dw = new DockableWidget(dockMan);
+		dw->setWidget(profilerView);
+		dw->setTitle(tr("Profiler"));
+		dw->setId("PROFILER");
+		dw->setFloating(true);
+		dw->setDestroyable(false);
+		dw->setMovable(true);
+		dw->setClosable(true);
+		connect(dw, SIGNAL(visibilityChanged(DockableWidget*)),
+		        this, SLOT(dockWidgetVisibilityChanged(DockableWidget*)));
+		connect(profilerView, SIGNAL(jumpToAddress(quint16)),
+		        disasmView, SLOT(setCursorAddress(quint16)));
+		connect(this, SIGNAL(symbolsChanged()),
+		        profilerView, SLOT(refresh()));
+		profilerView->setEnabled(disasmView->isEnabled());
+		profilerView->refresh();
+	} else {
+		toggleView(qobject_cast<DockableWidget*>(profilerView->parentWidget()));
+	}
+}
+
+void DebuggerForm::toggleCoverageDisplay()
+{
+	if (coverageView == NULL) {
+		coverageView = new CoverageViewer();
+		coverageView->setCollector(coverageCollector, &session.coverage());
+		coverageView->setSymbolTable(&session.symbolTable());
+		DockableWidget* dw = new DockableWidget(dockMan);
+		dw->setWidget(coverageView);
+		dw->setTitle(tr("Code coverage"));
+		dw->setId("COVERAGE");
+		dw->setFloating(true);
+		dw->setDestroyable(false);
+		dw->setMovable(true);
+		dw->setClosable(true);
+		connect(dw, SIGNAL(visibilityChanged(DockableWidget*)),
+		        this, SLOT(dockWidgetVisibilityChanged(DockableWidget*)));
+		connect(coverageView, SIGNAL(jumpToAddress(quint16)),
+		        disasmView, SLOT(setCursorAddress(quint16)));
+		connect(this, SIGNAL(symbolsChanged()),
+		        coverageView, SLOT(symbolsChanged()));
+		coverageView->setEnabled(disasmView->isEnabled());
+		coverageView->refresh();
+	} else {
+		toggleView(qobject_cast<DockableWidget*>(coverageView->parentWidget()));
+	}
+}
+
+void DebuggerForm::toggleTraceDisplay()
+{
+	if (traceView == NULL) {
+		traceView = new TraceViewer();
+		traceView->setRecorder(traceRecorder, traceBuffer);
+		traceView->setSymbolTable(&session.symbolTable());
+		traceView->setMemoryLayout(&memLayout);
+		DockableWidget* dw = new DockableWidget(dockMan);
+		dw->setWidget(traceView);
+		dw->setTitle(tr("Instruction trace"));
+		dw->setId("TRACE");
+		dw->setFloating(true);
+		dw->setDestroyable(false);
+		dw->setMovable(true);
+		dw->setClosable(true);
+		connect(dw, SIGNAL(visibilityChanged(DockableWidget*)),
+		        this, SLOT(dockWidgetVisibilityChanged(DockableWidget*)));
+		connect(traceView, SIGNAL(jumpToAddress(quint16)),
+		        disasmView, SLOT(setCursorAddress(quint16)));
+		connect(this, SIGNAL(settingsChanged()),
+		        traceView, SLOT(settingsChanged()));
+		connect(this, SIGNAL(symbolsChanged()),
+		        traceView, SLOT(update()));
+		traceView->setEnabled(disasmView->isEnabled());
+	} else {
+		toggleView(qobject_cast<DockableWidget*>(traceView->parentWidget()));
+	}
+}
+
+void DebuggerForm::toggleHeatmapDisplay()
+{
+	if (heatmapView == NULL) {
+		heatmapView = new HeatmapViewer();
+		heatmapView->setHeatmap(heatmap);
+		heatmapView->setSymbolTable(&session.symbolTable());
+		heatmapView->setMemoryLayout(&memLayout);
+		DockableWidget* dw = new DockableWidget(dockMan);
+		dw->setWidget(heatmapView);
+		dw->setTitle(tr("Memory heatmap"));
+		dw->setId("HEATMAP");
+		dw->setFloating(true);
+		dw->setDestroyable(false);
+		dw->setMovable(true);
+		dw->setClosable(true);
+		connect(dw, SIGNAL(visibilityChanged(DockableWidget*)),
+		        this, SLOT(dockWidgetVisibilityChanged(DockableWidget*)));
+		connect(heatmapView, SIGNAL(jumpToAddress(int)),
+		        mainMemoryView, SLOT(setLocation(int)));
+		connect(this, SIGNAL(symbolsChanged()),
+		        heatmapView, SLOT(refresh()));
+		heatmapView->setEnabled(disasmView->isEnabled());
+		heatmapView->refresh();
+	} else {
+		toggleView(qobject_cast<DockableWidget*>(heatmapView->parentWidget()));
+	}
+}
+
+void DebuggerForm::toggleTracepointsDisplay()
+{
+	if (tracepointView == NULL) {
+		tracepointView = new TracepointViewer();
+		tracepointView->setLog(tracepointLog);
+		tracepointView->setSymbolTable(&session.symbolTable());
+		tracepointView->setMemoryLayout(&memLayout);
+		DockableWidget* dw = new DockableWidget(dockMan);
+		dw->setWidget(tracepointView);
+		dw->setTitle(tr("Tracepoints"));
+		dw->setId("TRACEPOINTS");
+		dw->setFloating(true);
+		dw->setDestroyable(false);
+		dw->setMovable(true);
+		dw->setClosable(true);
+		connect(dw, SIGNAL(visibilityChanged(DockableWidget*)),
+		        this, SLOT(dockWidgetVisibilityChanged(DockableWidget*)));
+		connect(tracepointView, SIGNAL(jumpToAddress(quint16)),
+		        disasmView, SLOT(setCursorAddress(quint16)));
+		connect(this, SIGNAL(settingsChanged()),
+		        tracepointView, SLOT(settingsChanged()));
+		connect(this, SIGNAL(symbolsChanged()),
+		        tracepointView, SLOT(refresh()));
+		tracepointView->setEnabled(disasmView->isEnabled());
+		tracepointView->refresh();
+	} else {
+		toggleView(qobject_cast<DockableWidget*>(tracepointView->parentWidget()));
+	}
+}
+
+void DebuggerForm::toggleSourceDisplay()
+{
+	if (sourceView == NULL) {
+		sourceView = new SourceViewer();
+		sourceView->setSourceMap(&session.sourceMap());
+		sourceView->setBreakpoints(&session.breakpoints());
+		sourceView->setMemoryLayout(&memLayout);
+		DockableWidget* dw = new DockableWidget(dockMan);
+		dw->setWidget(sourceView);
+		dw->setTitle(tr("Source"));
+		dw->setId("SOURCE");
+		dw->setFloating(true);
+		dw->setDestroyable(false);
+		dw->setMovable(true);
+		dw->setClosable(true);
+		connect(dw, SIGNAL(visibilityChanged(DockableWidget*)),
+		        this, SLOT(dockWidgetVisibilityChanged(DockableWidget*)));
+		connect(regsView, SIGNAL(pcChanged(quint16)),
+		        sourceView, SLOT(setProgramCounter(quint16)));
+		connect(sourceView, SIGNAL(toggleBreakpoint(int)),
+		        this, SLOT(breakpointToggle(int)));
+		connect(sourceView, SIGNAL(sourceMapChanged()),
+		        this, SLOT(sourceMapChanged()));
+		connect(this, SIGNAL(settingsChanged()),
+		        sourceView, SLOT(settingsChanged()));
+		sourceView->setEnabled(disasmView->isEnabled());
+		if (disasmView->isEnabled()) {
+			sourceView->setProgramCounter(regsView->readRegister(CpuRegs::REG_PC));
+		} else {
+			sourceView->refresh();
+		}
+	} else {
+		toggleView(qobject_cast<DockableWidget*>(sourceView->parentWidget()));
+	}
+}
+
+void DebuggerForm::coverageChanged()
+{
+	disasmView->update();
+	session.sessionModified();
+	updateWindowTitle();
+}
+
+void DebuggerForm::sourceMapChanged()
+{
+	session.sessionModified();
+	updateWindowTitle();
+}
+
+void DebuggerForm::memoryLayoutChanged()
+{
+	// breakpoint markers and labels depend on what is mapped in
+	session.breakpoints().layoutChanged();
+	session.symbolTable().layoutChanged();
+	disasmView->update();
+	// the pc may be in another segment's source now
+	if (sourceView) sourceView->refresh();
+}
+
 void DebuggerForm::toggleVDPRegsDisplay()
 {
 	if (VDPRegView == NULL) {
@@ -1349,6 +1857,12 @@ void DebuggerForm::updateViewMenu()
 	viewStackAction->setChecked(stackView->isVisible());
 	viewSlotsAction->setChecked(slotView->isVisible());
 	viewMemoryAction->setChecked(mainMemoryView->isVisible());
+	viewProfilerAction->setChecked(profilerView && profilerView->isVisible());
+	viewCoverageAction->setChecked(coverageView && coverageView->isVisible());
+	viewTraceAction->setChecked(traceView && traceView->isVisible());
+	viewHeatmapAction->setChecked(heatmapView && heatmapView->isVisible());
+	viewTracepointsAction->setChecked(tracepointView && tracepointView->isVisible());
+	viewSourceAction->setChecked(sourceView && sourceView->isVisible());
 }
 
 void DebuggerForm::updateVDPViewMenu()
@@ -1414,17 +1928,5 @@ void DebuggerForm::symbolFileChanged()
 
 void DebuggerForm::addressSlot(int addr, int& ps, int& ss, int& segment)
 {
-	int p = (addr & 0xC000) >> 14;
-	ps = memLayout.primarySlot[p];
-	// figure out secondary slot
-	ss = memLayout.isSubslotted[ps] ? memLayout.secondarySlot[p] : -1;
-	// figure out (rom) mapper segment
-	segment = -1;
-	if (memLayout.mapperSize[ps][ss==-1 ? 0 : ss] > 0)
-		segment = memLayout.mapperSegment[p];
-	else {
-		int q = 2*p + ((addr & 0x2000) >> 13);
-		if (memLayout.romBlock[q] >= 0)
-			segment = memLayout.romBlock[q];
-	}
+	memLayout.addressSlot(addr, ps, ss, segment);
 }
@@ -20,6 +20,19 @@ class QToolBar;
 class VDPStatusRegViewer;
 class VDPRegViewer;
 class VDPCommandRegViewer;
+class Profiler;
+class ProfilerViewer;
+class CoverageCollector;
+class CoverageViewer;
+class TraceBuffer;
+class TraceRecorder;
+class TraceViewer;
+class MemoryHeatmap;
+class HeatmapViewer;
+class TracepointLog;
+class TracepointViewer;
+class SourceViewer;
+class Symbol;
 
 class DebuggerForm : public QMainWindow
 {
@@ -93,8 +106,15 @@ private:
 	QAction* viewSlotsAction;
 	QAction* viewMemoryAction;
 	QAction* viewDebuggableViewerAction;
+	QAction* viewProfilerAction;
+	QAction* viewCoverageAction;
+	QAction* viewTraceAction;
+	QAction* viewHeatmapAction;
+	QAction* viewTracepointsAction;
+	QAction* viewSourceAction;
 
 	QAction* viewBitMappedAction;
+	QAction* viewTileAction;
 	QAction* viewVDPStatusRegsAction;
 	QAction* viewVDPRegsAction;
 	QAction* viewVDPCommandRegsAction;
@@ -125,11 +145,23 @@ private:
 	VDPStatusRegViewer* VDPStatusRegView;
 	VDPRegViewer* VDPRegView;
 	VDPCommandRegViewer* VDPCommandRegView;
+	ProfilerViewer* profilerView;
+	CoverageViewer* coverageView;
+	TraceViewer* traceView;
+	HeatmapViewer* heatmapView;
+	TracepointViewer* tracepointView;
+	SourceViewer* sourceView;
 
 	CommClient& comm;
 	DebugSession session;
 	MemoryLayout memLayout;
 	unsigned char* mainMemory;
+	Profiler* profiler;
+	CoverageCollector* coverageCollector;
+	TraceBuffer* traceBuffer;
+	TraceRecorder* traceRecorder;
+	MemoryHeatmap* heatmap;
+	TracepointLog* tracepointLog;
 
 	bool mergeBreakpoints;
 	QMap<QString, int> debuggables;
@@ -153,9 +185,19 @@ private slots:
 	void toggleSlotsDisplay();
 	void toggleMemoryDisplay();
 	void toggleBitMappedDisplay();
+	void toggleTileDisplay();
 	void toggleVDPRegsDisplay();
 	void toggleVDPStatusRegsDisplay();
 	void toggleVDPCommandRegsDisplay();
+	void toggleProfilerDisplay();
+	void toggleCoverageDisplay();
+	void toggleTraceDisplay();
+	void toggleHeatmapDisplay();
+	void toggleTracepointsDisplay();
+	void toggleSourceDisplay();
+	void coverageChanged();
+	void sourceMapChanged();
+	void memoryLayoutChanged();
 	void addDebuggableViewer();
 	void executeBreak();
 	void executeRun();
@@ -166,6 +208,8 @@ private slots:
 	void executeStepBack();
 	void breakpointToggle(int addr = -1);
 	void breakpointAdd();
+	void breakpointsAddSymbols(const QList<Symbol*>& symbols);
+	void breakpointsRemoveSymbols(const QList<Symbol*>& symbols);
 
 	void handleCommandReplyStatus(bool status);
 	
@@ -185,6 +229,7 @@ private slots:
 	friend class QueryPauseHandler;
 	friend class QueryBreakedHandler;
 	friend class ListBreakPointsHandler;
+	friend class BreakCommandHandler;
 	friend class CPURegRequest;
 	friend class ListDebuggablesHandler;
 	friend class DebuggableSizeHandler;
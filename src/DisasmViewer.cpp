@@ -2,6 +2,7 @@
 #include "OpenMSXConnection.h"
 #include "CommClient.h"
 #include "DebuggerData.h"
+#include "Profiler.h"
 #include "Settings.h"
 #include <QPaintEvent>
 #include <QPainter>
@@ -68,6 +69,8 @@ DisasmViewer::DisasmViewer(QWidget* parent)
 	programAddr = 0xFFFF;
 	waitingForData = false;
 	nextRequest = NULL;
+	profiler = NULL;
+	coverage = NULL;
 
 	scrollBar = new QScrollBar(Qt::Vertical, this);
 	scrollBar->setMinimum(0);
@@ -154,6 +157,29 @@ void DisasmViewer::symbolsChanged()
 	}
 }
 
+void DisasmViewer::labelsChanged(const QList<int>& addresses)
+{
+	// a label on an operand changes the lines as well, so always redo the
+	// disassembly; the memory didn't change, so it's done on the buffer
+	if (disasmLines.empty() || memory == NULL) return;
+	// the data that is on its way gets disassembled with the new labels
+	if (waitingForData) return;
+
+	int disasmStart = disasmLines.front().addr;
+	int disasmEnd = disasmLines.back().addr + disasmLines.back().numBytes;
+	int topAddr = disasmLines[disasmTopLine].addr;
+	int topLine = disasmLines[disasmTopLine].infoLine;
+	dasm(memory, disasmStart, disasmEnd - 1, disasmLines,
+	     memLayout, symTable, programAddr);
+
+	disasmTopLine = findDisasmLine(topAddr, topLine);
+	disasmTopLine = std::max(disasmTopLine, 0);
+	disasmTopLine = std::min(disasmTopLine,
+	                         int(disasmLines.size()) - visibleLines);
+	disasmTopLine = std::max(disasmTopLine, 0);
+	update();
+}
+
 void DisasmViewer::paintEvent(QPaintEvent* e)
 {
 	// call parent for drawing the actual frame
@@ -233,6 +259,15 @@ void DisasmViewer::paintEvent(QPaintEvent* e)
 				p.setPen(s.fontColor(Settings::CODE_FONT));
 			}
 
+			// draw profiler heat behind the address
+			if (profiler && displayDisasm && !isCursorLine && row->infoLine == 0) {
+				if (quint32 n = profiler->samplesAt(row->addr, memLayout)) {
+					int alpha = 48 + int(207.0 * n / profiler->maxSamples());
+					p.fillRect(frameL + 32, y, xMCode[0] - frameL - 36, h,
+					           QColor(255, 128, 0, alpha));
+				}
+			}
+
 			// draw breakpoint marker
 			if (row->infoLine == 0) {
 				if (breakpoints->isBreakpoint(row->addr)) {
@@ -242,10 +277,20 @@ void DisasmViewer::paintEvent(QPaintEvent* e)
 									  Qt::red);
 						p.setPen(Qt::white);
 					}
+				} else if (breakpoints->isTracepoint(row->addr)) {
+					// faded, since execution doesn't stop here
+					p.setOpacity(0.4);
+					p.drawPixmap(frameL + 2, y + h / 2 -5, breakMarker);
+					p.setOpacity(1.0);
 				} else if (breakpoints->isWatchpoint(row->addr)) {
 					p.drawPixmap(frameL + 2, y + h / 2 -5, watchMarker);
 				}
 			}
+			// mark executed instructions
+			if (coverage && displayDisasm && row->infoLine == 0 &&
+			    coverage->isCovered(row->addr, memLayout)) {
+				p.fillRect(frameL + 29, y + 1, 3, h - 2, Qt::darkGreen);
+			}
 			// draw PC marker
 			if (row->addr == programAddr && row->infoLine == 0) {
 				p.drawPixmap(frameL + 18, y + h / 2 - 5, pcMarker);
@@ -548,6 +593,17 @@ void DisasmViewer::setSymbolTable(SymbolTable* st)
 	symTable = st;
 }
 
+void DisasmViewer::setCoverage(const CoverageMap* map)
+{
+	coverage = map;
+}
+
+void DisasmViewer::setProfiler(Profiler* p)
+{
+	profiler = p;
+	connect(profiler, SIGNAL(profileChanged()), this, SLOT(update()));
+}
+
 void DisasmViewer::keyPressEvent(QKeyEvent* e)
 {
 	switch (e->key()) {
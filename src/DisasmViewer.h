@@ -9,6 +9,8 @@ class CommMemoryRequest;
 class QScrollBar;
 class Breakpoints;
 class SymbolTable;
+class Profiler;
+class CoverageMap;
 struct MemoryLayout;
 
 class DisasmViewer : public QFrame
@@ -21,6 +23,8 @@ public:
 	void setBreakpoints(Breakpoints* bps);
 	void setMemoryLayout(MemoryLayout* ml);
 	void setSymbolTable(SymbolTable* st);
+	void setProfiler(Profiler* p);
+	void setCoverage(const CoverageMap* map);
 	void memoryUpdated(CommMemoryRequest* req);
 	void updateCancelled(CommMemoryRequest* req);
 	quint16 programCounter() const;
@@ -38,6 +42,7 @@ public slots:
 	void scrollBarChanged(int value);
 	void settingsChanged();
 	void symbolsChanged();
+	void labelsChanged(const QList<int>& addresses);
 
 private:
 	void resizeEvent(QResizeEvent* e);
@@ -74,6 +79,8 @@ private:
 	Breakpoints* breakpoints;
 	MemoryLayout* memLayout;
 	SymbolTable* symTable;
+	Profiler* profiler;
+	const CoverageMap* coverage;
 
 	int findDisasmLine(quint16 lineAddr, int infoLine = 0);
 	int lineAtPos(const QPoint& pos);
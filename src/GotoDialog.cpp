@@ -1,7 +1,7 @@
 #include "GotoDialog.h"
 #include "DebugSession.h"
+#include "LabelCompleter.h"
 #include "Convert.h"
-#include <QCompleter>
 
 
 GotoDialog::GotoDialog(const MemoryLayout& ml, DebugSession *session, QWidget* parent)
@@ -12,9 +12,10 @@ GotoDialog::GotoDialog(const MemoryLayout& ml, DebugSession *session, QWidget* p
 	debugSession = session;
 	if( session ) {
 		// create address completer
-		QCompleter *completer = new QCompleter(session->symbolTable().labelList(true, &ml), this);
-		completer->setCaseSensitivity(Qt::CaseInsensitive);
+		LabelCompleter *completer = new LabelCompleter(session->symbolTable(), true, this);
+		completer->setMemoryLayout(&ml);
 		edtAddress->setCompleter(completer);
+		connect(edtAddress, SIGNAL(textEdited(const QString&)), completer, SLOT(setPrefix(const QString&)));
 		connect(completer,  SIGNAL(activated(const QString&)), this, SLOT(addressChanged(const QString&)));
 	}
 
@@ -35,7 +36,6 @@ void GotoDialog::addressChanged(const QString& text)
 	if (addr == -1 && debugSession) {
 		// try finding a label
 		currentSymbol = debugSession->symbolTable().getAddressSymbol(text);
-		if (!currentSymbol) currentSymbol = debugSession->symbolTable().getAddressSymbol(text, Qt::CaseInsensitive);
 		if (currentSymbol) addr = currentSymbol->value();
 	}
 
@@ -0,0 +1,188 @@
+#include "HeatmapViewer.h"
+#include "MemoryHeatmap.h"
+#include "SymbolTable.h"
+#include "Convert.h"
+#include <QHBoxLayout>
+#include <QHash>
+#include <QLabel>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+
+// only the hottest variables are worth showing
+static const int MAX_VARIABLES = 200;
+// accesses this far behind a label are counted as part of that variable
+static const int MAX_VARIABLE_SIZE = 16;
+
+namespace {
+
+struct Variable {
+	int address;
+	int endAddress;
+	quint64 reads;
+	quint64 writes;
+	QString name;
+};
+
+bool hotter(const Variable& a, const Variable& b)
+{
+	return (a.reads + a.writes) > (b.reads + b.writes);
+}
+
+}
+
+HeatmapViewer::HeatmapViewer(QWidget* parent)
+	: QWidget(parent)
+{
+	recordButton = new QPushButton(tr("Record"));
+	recordButton->setCheckable(true);
+	recordButton->setToolTip(tr("Count all memory reads and writes"));
+	clearButton = new QPushButton(tr("Clear"));
+
+	totalLabel = new QLabel();
+
+	hotList = new QTreeWidget();
+	hotList->setRootIsDecorated(false);
+	hotList->setColumnCount(5);
+	hotList->setHeaderLabels(QStringList() << tr("Variable") << tr("Address")
+	                                       << tr("Reads") << tr("Writes")
+	                                       << tr("Total"));
+	hotList->setSortingEnabled(true);
+	hotList->sortByColumn(4, Qt::DescendingOrder);
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->setMargin(0);
+	hbox->addWidget(recordButton);
+	hbox->addWidget(clearButton);
+	hbox->addStretch();
+	hbox->addWidget(totalLabel);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->setMargin(0);
+	vbox->addLayout(hbox);
+	vbox->addWidget(hotList);
+	setLayout(vbox);
+
+	heatmap = 0;
+	symTable = 0;
+	memLayout = 0;
+
+	connect(recordButton, SIGNAL(toggled(bool)), this, SLOT(startStop(bool)));
+	connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+	connect(hotList, SIGNAL(itemActivated(QTreeWidgetItem*, int)),
+	        this, SLOT(itemActivated(QTreeWidgetItem*)));
+}
+
+void HeatmapViewer::setHeatmap(MemoryHeatmap* map)
+{
+	heatmap = map;
+	connect(heatmap, SIGNAL(heatmapChanged()), this, SLOT(refresh()));
+	connect(heatmap, SIGNAL(runningChanged(bool)), this, SLOT(runningChanged(bool)));
+}
+
+void HeatmapViewer::setSymbolTable(SymbolTable* st)
+{
+	symTable = st;
+}
+
+void HeatmapViewer::setMemoryLayout(MemoryLayout* ml)
+{
+	memLayout = ml;
+}
+
+void HeatmapViewer::startStop(bool checked)
+{
+	if (!heatmap || checked == heatmap->isRunning()) return;
+	if (checked) {
+		heatmap->start();
+	} else {
+		heatmap->stop();
+	}
+}
+
+void HeatmapViewer::runningChanged(bool running)
+{
+	recordButton->setChecked(running);
+	recordButton->setText(running ? tr("Stop") : tr("Record"));
+}
+
+void HeatmapViewer::clear()
+{
+	if (heatmap) heatmap->clear();
+}
+
+void HeatmapViewer::refresh()
+{
+	if (!heatmap) return;
+
+	totalLabel->setText(tr("%1 accesses in %2 s")
+		.arg(heatmap->totalCount())
+		.arg(heatmap->windowLength() / 1000.0, 0, 'f', 1));
+
+	// rebuilding the list is only needed when someone looks at it
+	if (!isVisible()) return;
+
+	// group accessed addresses under the label they belong to, the labels
+	// are walked along with the addresses and the last one is carried on
+	QList<Variable> vars;
+	QHash<const Symbol*, int> symbolVars;
+	SymbolTable::AddressIterator labels;
+	if (symTable) labels = symTable->addressSymbols(0, memLayout);
+	const Symbol* label = 0;
+	for (int addr = 0; addr < 0x10000; ++addr) {
+		quint32 r = heatmap->reads(addr);
+		quint32 w = heatmap->writes(addr);
+		if (r == 0 && w == 0) continue;
+
+		for (; !labels.atEnd() && labels->value() <= addr; ++labels) {
+			// of the labels on one address the first one is used
+			if (!label || labels->value() != label->value()) label = *labels;
+		}
+		const Symbol* sym = (label && addr - label->value() < MAX_VARIABLE_SIZE)
+		                  ? label : 0;
+		int idx = sym ? symbolVars.value(sym, -1) : -1;
+		if (idx < 0) {
+			Variable v;
+			v.address = sym ? sym->value() : addr;
+			v.endAddress = addr;
+			v.reads = 0;
+			v.writes = 0;
+			v.name = sym ? sym->text() : QString("$%1").arg(hexValue(addr, 4).toUpper());
+			idx = vars.size();
+			vars.append(v);
+			if (sym) symbolVars.insert(sym, idx);
+		}
+		vars[idx].reads += r;
+		vars[idx].writes += w;
+		vars[idx].endAddress = addr;
+	}
+	std::stable_sort(vars.begin(), vars.end(), hotter);
+
+	hotList->setSortingEnabled(false);
+	hotList->clear();
+	for (int i = 0; i < vars.size() && i < MAX_VARIABLES; ++i) {
+		const Variable& v = vars[i];
+		QTreeWidgetItem* item = new QTreeWidgetItem(hotList);
+		item->setText(0, v.name);
+		QString range = hexValue(v.address, 4).toUpper();
+		if (v.endAddress != v.address) {
+			range += "-" + hexValue(v.endAddress, 4).toUpper();
+		}
+		item->setText(1, range);
+		item->setData(1, Qt::UserRole, v.address);
+		// store numbers so sorting isn't alphabetical
+		item->setData(2, Qt::DisplayRole, v.reads);
+		item->setData(3, Qt::DisplayRole, v.writes);
+		item->setData(4, Qt::DisplayRole, v.reads + v.writes);
+		item->setTextAlignment(2, Qt::AlignRight);
+		item->setTextAlignment(3, Qt::AlignRight);
+		item->setTextAlignment(4, Qt::AlignRight);
+	}
+	hotList->setSortingEnabled(true);
+}
+
+void HeatmapViewer::itemActivated(QTreeWidgetItem* item)
+{
+	emit jumpToAddress(item->data(1, Qt::UserRole).toInt());
+}
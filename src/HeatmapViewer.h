@@ -0,0 +1,47 @@
+#ifndef HEATMAPVIEWER_H
+#define HEATMAPVIEWER_H
+
+#include <QWidget>
+
+class MemoryHeatmap;
+class SymbolTable;
+struct MemoryLayout;
+class QLabel;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+class HeatmapViewer : public QWidget
+{
+	Q_OBJECT
+public:
+	HeatmapViewer(QWidget* parent = 0);
+
+	void setHeatmap(MemoryHeatmap* map);
+	void setSymbolTable(SymbolTable* st);
+	void setMemoryLayout(MemoryLayout* ml);
+
+public slots:
+	void refresh();
+
+private slots:
+	void startStop(bool checked);
+	void runningChanged(bool running);
+	void clear();
+	void itemActivated(QTreeWidgetItem* item);
+
+signals:
+	void jumpToAddress(int addr);
+
+private:
+	QPushButton* recordButton;
+	QPushButton* clearButton;
+	QLabel* totalLabel;
+	QTreeWidget* hotList;
+
+	MemoryHeatmap* heatmap;
+	SymbolTable* symTable;
+	MemoryLayout* memLayout;
+};
+
+#endif // HEATMAPVIEWER_H
@@ -2,6 +2,7 @@
 #include "OpenMSXConnection.h"
 #include "CommClient.h"
 #include "Settings.h"
+#include "MemoryHeatmap.h"
 #include <QScrollBar>
 #include <QPaintEvent>
 #include <QPainter>
@@ -65,6 +66,7 @@ HexViewer::HexViewer(QWidget* parent)
 	editedChars = false;
 	useMarker = false;
 	hasFocus = false;
+	heatmap = NULL;
 
 	vertScrollBar = new QScrollBar(Qt::Vertical, this);
 	vertScrollBar->setMinimum(0);
@@ -138,6 +140,12 @@ void HexViewer::setIsEditable(bool enabled)
 	setUseMarker(true);
 }
 
+void HexViewer::setHeatmap(const MemoryHeatmap* map)
+{
+	heatmap = map;
+	connect(heatmap, SIGNAL(heatmapChanged()), this, SLOT(update()));
+}
+
 void HexViewer::setUseMarker(bool enabled)
 {
 	useMarker = enabled;
@@ -303,6 +311,13 @@ void HexViewer::paintEvent(QPaintEvent* e)
 			// print data
 			if (address + j < debuggableSize) {
 				hexStr.sprintf("%02X", hexData[address + j]);
+				// draw access heat
+				if (heatmap) {
+					QColor heat = heatmap->color(address + j);
+					if (heat.isValid()) {
+						p.fillRect(x, y, dataWidth, lineHeight, heat);
+					}
+				}
 				// draw marker if needed
 				if (useMarker || beingEdited) {
 					QRect b(x, y, dataWidth, lineHeight);
@@ -704,6 +719,11 @@ bool HexViewer::event(QEvent* e)
 			text += "\nDecimal: ";
 			text += QString::number(wd);
 		}
+		if (heatmap) {
+			text += QString("\n\nReads: %1\nWrites: %2")
+			            .arg(heatmap->reads(address))
+			            .arg(heatmap->writes(address));
+		}
 		QToolTip::showText(helpEvent->globalPos(), text);
 	} else {
 		QToolTip::hideText();
@@ -4,6 +4,7 @@
 #include <QFrame>
 
 class HexRequest;
+class MemoryHeatmap;
 class QScrollBar;
 class QPaintEvent;
 
@@ -20,6 +21,7 @@ public:
 	void setIsInteractive(bool enabled);
 	void setUseMarker(bool enabled);
 	void setIsEditable(bool enabled);
+	void setHeatmap(const MemoryHeatmap* map);
 
 	void setDisplayMode(Mode mode);
 	void setDisplayWidth(short width);
@@ -82,6 +84,7 @@ private:
 	bool editedChars;
 	bool hasFocus;
 	int cursorPosition,editValue;
+	const MemoryHeatmap* heatmap;
 
 	friend class HexRequest;
 
@@ -0,0 +1,31 @@
+#include "LabelCompleter.h"
+#include "SymbolTable.h"
+#include <QStringListModel>
+
+// more than this doesn't fit in the popup anyway
+static const int MAX_COMPLETIONS = 50;
+
+LabelCompleter::LabelCompleter(const SymbolTable& table, bool includeVars,
+                               QObject* parent)
+	: QCompleter(parent), symTable(table)
+{
+	memLayout = 0;
+	includeVariables = includeVars;
+
+	labelModel = new QStringListModel(this);
+	setModel(labelModel);
+	// the model only holds matches, in the order the table ranked them
+	setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+	setCaseSensitivity(Qt::CaseInsensitive);
+}
+
+void LabelCompleter::setMemoryLayout(const MemoryLayout* ml)
+{
+	memLayout = ml;
+}
+
+void LabelCompleter::setPrefix(const QString& text)
+{
+	labelModel->setStringList(symTable.labelCompletions(
+		text, MAX_COMPLETIONS, includeVariables, memLayout));
+}
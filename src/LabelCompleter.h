@@ -0,0 +1,34 @@
+#ifndef LABELCOMPLETER_H
+#define LABELCOMPLETER_H
+
+#include <QCompleter>
+
+class SymbolTable;
+struct MemoryLayout;
+class QStringListModel;
+
+/** Completer for label names. Instead of filtering a list of every label
+  * itself, it asks the symbol table for the best matches each time the
+  * text changes and only shows those. The edited text has to be passed in
+  * through setPrefix().
+  */
+class LabelCompleter : public QCompleter
+{
+	Q_OBJECT
+public:
+	LabelCompleter(const SymbolTable& table, bool includeVars,
+	               QObject* parent = 0);
+
+	void setMemoryLayout(const MemoryLayout* ml);
+
+public slots:
+	void setPrefix(const QString& text);
+
+private:
+	const SymbolTable& symTable;
+	const MemoryLayout* memLayout;
+	bool includeVariables;
+	QStringListModel* labelModel;
+};
+
+#endif // LABELCOMPLETER_H
@@ -3,6 +3,7 @@
 #include "CPURegs.h"
 #include "CPURegsViewer.h"
 #include "SymbolTable.h"
+#include "LabelCompleter.h"
 #include "Convert.h"
 #include <QComboBox>
 #include <QVBoxLayout>
@@ -53,6 +54,8 @@ MainMemoryViewer::MainMemoryViewer(QWidget* parent)
 	linkedId = 0;
 	regsViewer = NULL;
 	symTable = 0;
+	completer = 0;
+	memLayout = 0;
 
 	connect(hexView, SIGNAL(locationChanged(int)),
 	        this, SLOT(hexViewChanged(int)));
@@ -86,6 +89,27 @@ void MainMemoryViewer::setRegsView(CPURegsViewer* viewer)
 void MainMemoryViewer::setSymbolTable(SymbolTable* symtable)
 {
 	symTable = symtable;
+
+	// complete labels of code and variables that are currently visible
+	delete completer;
+	completer = new LabelCompleter(*symTable, true, this);
+	completer->setMemoryLayout(memLayout);
+	addressValue->setCompleter(completer);
+	connect(addressValue, SIGNAL(textEdited(const QString&)),
+	        completer, SLOT(setPrefix(const QString&)));
+	connect(completer, SIGNAL(activated(const QString&)),
+	        this, SLOT(addressValueChanged()));
+}
+
+void MainMemoryViewer::setMemoryLayout(const MemoryLayout* ml)
+{
+	memLayout = ml;
+	if (completer) completer->setMemoryLayout(ml);
+}
+
+void MainMemoryViewer::setHeatmap(const MemoryHeatmap* map)
+{
+	hexView->setHeatmap(map);
 }
 
 void MainMemoryViewer::refresh()
@@ -104,7 +128,6 @@ void MainMemoryViewer::addressValueChanged()
 	if (addr == -1 && symTable) {
 		// try finding a label
 		Symbol *s = symTable->getAddressSymbol(addressValue->text());
-		if (!s) s = symTable->getAddressSymbol(addressValue->text(), Qt::CaseInsensitive);
 		if (s) addr = s->value();
 	}
 
@@ -6,6 +6,9 @@
 class HexViewer;
 class CPURegsViewer;
 class SymbolTable;
+class LabelCompleter;
+class MemoryHeatmap;
+struct MemoryLayout;
 class QComboBox;
 class QLineEdit;
 
@@ -18,6 +21,8 @@ public:
 	void setDebuggable(const QString& name, int size);
 	void setRegsView(CPURegsViewer* viewer);
 	void setSymbolTable(SymbolTable* symtable);
+	void setMemoryLayout(const MemoryLayout* ml);
+	void setHeatmap(const MemoryHeatmap* map);
 
 public slots:
 	void setLocation(int addr);
@@ -37,6 +42,8 @@ private:
 	static const int linkRegisters[];
 	CPURegsViewer* regsViewer;
 	SymbolTable* symTable;
+	LabelCompleter* completer;
+	const MemoryLayout* memLayout;
 	int linkedId;
 	bool isLinked;
 };
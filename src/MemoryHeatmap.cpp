@@ -0,0 +1,175 @@
+#include "MemoryHeatmap.h"
+#include "CommClient.h"
+#include "OpenMSXConnection.h"
+#include "Convert.h"
+#include <algorithm>
+#include <cmath>
+
+// length of a single entry in the fetched data: R/W, address and count
+static const int ENTRY_LENGTH = 13;
+
+
+MemoryHeatmap::MemoryHeatmap(QObject* parent)
+	: QObject(parent)
+	, readCounts(0x10000, 0)
+	, writeCounts(0x10000, 0)
+	, fetcher("debug_access_fetch",
+	          [this](const QString& data) { addCounts(data); })
+{
+	maxHits = 0;
+	total = 0;
+	windowTime = 0;
+	running = false;
+
+	fetchTimer.setInterval(500);
+	connect(&fetchTimer, SIGNAL(timeout()), this, SLOT(fetch()));
+	connect(&CommClient::instance(), SIGNAL(connectionTerminated()),
+	        this, SLOT(connectionClosed()));
+}
+
+bool MemoryHeatmap::isRunning() const
+{
+	return running;
+}
+
+qint64 MemoryHeatmap::windowLength() const
+{
+	return windowTime + (running ? window.elapsed() : 0);
+}
+
+quint32 MemoryHeatmap::reads(int addr) const
+{
+	return readCounts[addr & 0xFFFF];
+}
+
+quint32 MemoryHeatmap::writes(int addr) const
+{
+	return writeCounts[addr & 0xFFFF];
+}
+
+quint32 MemoryHeatmap::maxCount() const
+{
+	return maxHits;
+}
+
+quint64 MemoryHeatmap::totalCount() const
+{
+	return total;
+}
+
+QColor MemoryHeatmap::color(int addr) const
+{
+	quint32 r = readCounts[addr & 0xFFFF];
+	quint32 w = writeCounts[addr & 0xFFFF];
+	if ((r | w) == 0) return QColor();
+
+	// blue for reads, red for writes, purple for both; a logarithmic
+	// saturation keeps rarely accessed addresses visible
+	int hue = w == 0 ? 220 : (r == 0 ? 0 : 290);
+	double heat = log(1.0 + std::max(r, w)) / log(2.0 + maxHits);
+	return QColor::fromHsv(hue, 40 + int(180 * heat), 255);
+}
+
+void MemoryHeatmap::start()
+{
+	if (running) return;
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_hook_access_read { } {\n"
+		"  incr ::debug_access_reads($::wp_last_address)\n"
+		"}\n"
+		"proc debug_hook_access_write { } {\n"
+		"  incr ::debug_access_writes($::wp_last_address)\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_access_fetch { } {\n"
+		"  set result \"\"\n"
+		"  foreach {addr n} [array get ::debug_access_reads] {\n"
+		"    append result [format R%04X%08X $addr $n]\n"
+		"  }\n"
+		"  foreach {addr n} [array get ::debug_access_writes] {\n"
+		"    append result [format W%04X%08X $addr $n]\n"
+		"  }\n"
+		"  array unset ::debug_access_reads\n"
+		"  array unset ::debug_access_writes\n"
+		"  return $result\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"array unset ::debug_access_reads\n"
+		"array unset ::debug_access_writes\n"
+		"set ::debug_access_ids [list "
+		"[debug set_watchpoint read_mem {0 0xFFFF} {} debug_hook_access_read] "
+		"[debug set_watchpoint write_mem {0 0xFFFF} {} debug_hook_access_write]]"));
+
+	running = true;
+	window.start();
+	fetchTimer.start();
+	emit runningChanged(true);
+}
+
+void MemoryHeatmap::stop()
+{
+	if (!running) return;
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"foreach id $::debug_access_ids { debug remove_watchpoint $id }"));
+	// collect the counts since the last fetch, even when a periodic fetch
+	// is still underway
+	fetcher.fetchNow();
+	running = false;
+	windowTime += window.elapsed();
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void MemoryHeatmap::clear()
+{
+	std::fill(readCounts.begin(), readCounts.end(), 0);
+	std::fill(writeCounts.begin(), writeCounts.end(), 0);
+	maxHits = 0;
+	total = 0;
+	windowTime = 0;
+	if (running) window.restart();
+	emit heatmapChanged();
+}
+
+void MemoryHeatmap::fetch()
+{
+	if (!running) return;
+	fetcher.fetch();
+}
+
+void MemoryHeatmap::connectionClosed()
+{
+	if (!running) return;
+	running = false;
+	windowTime += window.elapsed();
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void MemoryHeatmap::addCounts(const QString& data)
+{
+	int count = data.size() / ENTRY_LENGTH;
+	if (count == 0) return;
+
+	QByteArray bytes = data.toLatin1();
+	const char* p = bytes.constData();
+	for (int i = 0; i < count; ++i, p += ENTRY_LENGTH) {
+		int addr = 0;
+		for (int j = 1; j < 5; ++j) {
+			addr = (addr << 4) | hexDigitValue(p[j]);
+		}
+		quint32 n = 0;
+		for (int j = 5; j < 13; ++j) {
+			n = (n << 4) | hexDigitValue(p[j]);
+		}
+		quint32& c = (p[0] == 'W' ? writeCounts : readCounts)[addr];
+		c += n;
+		maxHits = std::max(maxHits, c);
+		total += n;
+	}
+	emit heatmapChanged();
+}
@@ -0,0 +1,62 @@
+#ifndef MEMORYHEATMAP_H
+#define MEMORYHEATMAP_H
+
+#include "OpenMSXConnection.h"
+#include <QObject>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <vector>
+
+/** Counts memory reads and writes per address.
+  * Two watchpoints covering the whole address space call hooks in openMSX
+  * that only increment counters, so the emulation isn't stopped for every
+  * access. The debugger periodically fetches the counters that changed and
+  * adds them to its own histogram.
+  */
+class MemoryHeatmap : public QObject
+{
+	Q_OBJECT
+public:
+	MemoryHeatmap(QObject* parent = 0);
+
+	bool isRunning() const;
+	// time covered by the counters in milliseconds
+	qint64 windowLength() const;
+
+	quint32 reads(int addr) const;
+	quint32 writes(int addr) const;
+	quint32 maxCount() const;
+	quint64 totalCount() const;
+	// overlay colour for addr, invalid when it wasn't accessed
+	QColor color(int addr) const;
+
+public slots:
+	void start();
+	void stop();
+	void clear();
+	void fetch();
+
+signals:
+	void heatmapChanged();
+	void runningChanged(bool running);
+
+private slots:
+	void connectionClosed();
+
+private:
+	void addCounts(const QString& data);
+
+	std::vector<quint32> readCounts;
+	std::vector<quint32> writeCounts;
+	quint32 maxHits;
+	quint64 total;
+
+	QElapsedTimer window;
+	qint64 windowTime;
+	bool running;
+	SingleFetch fetcher;
+	QTimer fetchTimer;
+};
+
+#endif // MEMORYHEATMAP_H
@@ -1,4 +1,6 @@
 #include "OpenMSXConnection.h"
+#include "CommClient.h"
+#include "Convert.h"
 #include <QXmlInputSource>
 #include <QXmlSimpleReader>
 #include <cassert>
@@ -71,17 +73,62 @@ WriteDebugBlockCommand::WriteDebugBlockCommand(const QString& debuggable,
 }
 
 
-static unsigned char hex2val(char c)
-{
-	return (c <= '9') ? (c - '0') : (c - 'A' + 10);
-}
 void ReadDebugBlockCommand::copyData(const QString& message)
 {
 	assert(static_cast<unsigned>(message.size()) == 2 * size);
-	for (unsigned i = 0; i < size; ++i) {
-		target[i] = (hex2val(message[2 * i + 0].toLatin1()) << 4) +
-		            (hex2val(message[2 * i + 1].toLatin1()) << 0);
+	hexToBytes(message.constData(), size, target);
+}
+
+
+class SingleFetch::Request : public SimpleCommand
+{
+public:
+	Request(SingleFetch& fetch_)
+		: SimpleCommand(fetch_.command)
+		, fetch(fetch_)
+	{
 	}
+
+	virtual void replyOk(const QString& message)
+	{
+		--fetch.outstanding;
+		fetch.handler(message);
+		delete this;
+	}
+
+	virtual void cancel()
+	{
+		--fetch.outstanding;
+		delete this;
+	}
+
+private:
+	SingleFetch& fetch;
+};
+
+SingleFetch::SingleFetch(const QString& command_, const Handler& handler_)
+	: command(command_)
+	, handler(handler_)
+	, outstanding(0)
+{
+}
+
+void SingleFetch::fetch()
+{
+	// don't stack up requests when openMSX is busy
+	if (outstanding) return;
+	fetchNow();
+}
+
+void SingleFetch::fetchNow()
+{
+	++outstanding;
+	CommClient::instance().sendCommand(new Request(*this));
+}
+
+bool SingleFetch::isFetching() const
+{
+	return outstanding != 0;
 }
 
 
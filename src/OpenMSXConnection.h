@@ -6,6 +6,7 @@
 #include <QXmlDefaultHandler>
 #include <QQueue>
 #include <memory>
+#include <functional>
 
 class QXmlInputSource;
 class QXmlSimpleReader;
@@ -59,6 +60,32 @@ public:
 	                      unsigned char* source);
 };
 
+/** Sends a command that collects the data gathered in openMSX since the
+  * previous one, and passes the reply to a handler. A periodic fetch is
+  * skipped while the reply to the previous one is still due.
+  */
+class SingleFetch
+{
+public:
+	typedef std::function<void(const QString& message)> Handler;
+
+	SingleFetch(const QString& command, const Handler& handler);
+
+	void fetch();
+	/** Sends the command even when a reply is still due, to collect
+	  * everything up to now.
+	  */
+	void fetchNow();
+	bool isFetching() const;
+
+private:
+	class Request;
+
+	QString command;
+	Handler handler;
+	int outstanding;
+};
+
 class OpenMSXConnection : public QObject, private QXmlDefaultHandler
 {
 	Q_OBJECT
@@ -0,0 +1,307 @@
+#include "Profiler.h"
+#include "CommClient.h"
+#include "OpenMSXConnection.h"
+#include "DebuggerData.h"
+#include "SymbolTable.h"
+#include "Dasm.h"
+#include "Convert.h"
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
+// maximum number of samples buffered in openMSX between two fetches
+static const int SAMPLE_BUFFER_SIZE = 65536;
+// bytes of a basic block that are disassembled when grouping
+static const int MAX_BLOCK_SIZE = 64;
+// length of a single sample in the fetched data: PPPP S s GGG
+static const int SAMPLE_LENGTH = 9;
+
+
+Profiler::Profiler(QObject* parent)
+	: QObject(parent)
+	, fetcher("debug_profile_fetch",
+	          [this](const QString& data) { addSamples(data); })
+{
+	total = 0;
+	maxHits = 0;
+	sampleInterval = 1000;
+	running = false;
+
+	fetchTimer.setInterval(500);
+	connect(&fetchTimer, SIGNAL(timeout()), this, SLOT(fetch()));
+	connect(&CommClient::instance(), SIGNAL(connectionTerminated()),
+	        this, SLOT(connectionClosed()));
+}
+
+bool Profiler::isRunning() const
+{
+	return running;
+}
+
+int Profiler::interval() const
+{
+	return sampleInterval;
+}
+
+quint32 Profiler::totalSamples() const
+{
+	return total;
+}
+
+quint32 Profiler::maxSamples() const
+{
+	return maxHits;
+}
+
+quint32 Profiler::samplesAt(int addr, const MemoryLayout* ml) const
+{
+	if (hits.isEmpty()) return 0;
+	quint32 key = (quint32(ml ? ml->slotKey(addr) : 0) << 16) | (addr & 0xFFFF);
+	return hits.value(key, 0);
+}
+
+void Profiler::start(int usec)
+{
+	if (running) stop();
+	sampleInterval = usec;
+
+	// the sampler reschedules itself in emulated time, so the samples are
+	// distributed over the executed code and not over the host's timing
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_profile_sample { } {\n"
+		"  set pc [reg PC]\n"
+		"  append ::debug_profile_buf [format %04X $pc] [debug_slot_key $pc]\n"
+		"  if { [string length $::debug_profile_buf] &gt; 9 * $::debug_profile_max } {\n"
+		"    set ::debug_profile_buf [string range $::debug_profile_buf [expr {9 * ($::debug_profile_max / 4)}] end]\n"
+		"  }\n"
+		"  set ::debug_profile_id [after time $::debug_profile_interval debug_profile_sample]\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_profile_fetch { } {\n"
+		"  set result $::debug_profile_buf\n"
+		"  set ::debug_profile_buf \"\"\n"
+		"  return $result\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		QString("set ::debug_profile_buf \"\"\n"
+		        "set ::debug_profile_max %1\n"
+		        "set ::debug_profile_interval %2\n"
+		        "set ::debug_profile_id [after time $::debug_profile_interval debug_profile_sample]")
+		       .arg(SAMPLE_BUFFER_SIZE).arg(usec / 1000000.0, 0, 'f', 6)));
+
+	running = true;
+	fetchTimer.start();
+	emit runningChanged(true);
+}
+
+void Profiler::stop()
+{
+	if (!running) return;
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"after cancel $::debug_profile_id"));
+	running = false;
+	fetchTimer.stop();
+	// collect what was sampled since the last fetch
+	fetch();
+	emit runningChanged(false);
+}
+
+void Profiler::clear()
+{
+	hits.clear();
+	total = 0;
+	maxHits = 0;
+	emit profileChanged();
+}
+
+void Profiler::fetch()
+{
+	fetcher.fetch();
+}
+
+void Profiler::connectionClosed()
+{
+	if (!running) return;
+	running = false;
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void Profiler::addSamples(const QString& data)
+{
+	int count = data.size() / SAMPLE_LENGTH;
+	if (count == 0) return;
+
+	QByteArray bytes = data.toLatin1();
+	const char* p = bytes.constData();
+	for (int i = 0; i < count; ++i, p += SAMPLE_LENGTH) {
+		quint32 addr = 0;
+		for (int j = 0; j < 4; ++j) {
+			addr = (addr << 4) | hexDigitValue(p[j]);
+		}
+		quint32 seg = 0;
+		for (int j = 6; j < 9; ++j) {
+			seg = (seg << 4) | hexDigitValue(p[j]);
+		}
+		quint32 slot = makeSlotKey(hexDigitValue(p[4]), hexDigitValue(p[5]), seg);
+		quint32& n = hits[(slot << 16) | addr];
+		++n;
+		if (n > maxHits) maxHits = n;
+	}
+	total += count;
+	emit profileChanged();
+}
+
+static bool slotMatches(const Symbol* sym, int slotKey)
+{
+	int ps = slotKey & 3;
+	int ss = (slotKey >> 2) & 3;
+	return sym->validSlots() & (1 << (4 * ps + ss));
+}
+
+// find the closest jump label at or before addr that is valid in the slot
+static const Symbol* symbolBefore(const std::vector<const Symbol*>& syms,
+                                  int addr, int slotKey)
+{
+	std::vector<const Symbol*>::const_iterator it = std::upper_bound(
+		syms.begin(), syms.end(), addr,
+		[](int a, const Symbol* s) { return a < s->value(); });
+	while (it != syms.begin()) {
+		--it;
+		if (slotMatches(*it, slotKey)) return *it;
+	}
+	return 0;
+}
+
+static QString locationName(const Symbol* sym, int addr)
+{
+	if (!sym) return QString("$%1").arg(hexValue(addr, 4).toUpper());
+	if (sym->value() == addr) return sym->text();
+	return QString("%1+%2").arg(sym->text()).arg(addr - sym->value());
+}
+
+static bool endsBlock(const std::string& instr)
+{
+	static const char* const branches[] = {
+		"jp ", "jr ", "call ", "ret", "djnz ", "rst ", "halt", "db ", 0
+	};
+	for (int i = 0; branches[i]; ++i) {
+		if (instr.compare(0, strlen(branches[i]), branches[i]) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool hotter(const Profiler::HotSpot& a, const Profiler::HotSpot& b)
+{
+	return a.samples > b.samples;
+}
+
+QList<Profiler::HotSpot> Profiler::hotSpots(Grouping grouping,
+	SymbolTable* symTable, const unsigned char* mem, MemoryLayout* ml) const
+{
+	QList<HotSpot> spots;
+
+	// keys sort by slot first, then by address
+	QList<quint32> locations = hits.keys();
+	std::sort(locations.begin(), locations.end());
+
+	std::vector<const Symbol*> syms;
+	if (symTable) {
+		for (SymbolTable::AddressIterator it = symTable->addressSymbols();
+		     !it.atEnd(); ++it) {
+			Symbol* s = *it;
+			if (s->type() == Symbol::JUMPLABEL && s->status() == Symbol::ACTIVE) {
+				syms.push_back(s);
+			}
+		}
+	}
+
+	QHash<const Symbol*, int> symbolSpots;
+	QHash<int, int> unnamedSpots;
+	int blockEnd = -1;
+	int blockSlot = -1;
+	QList<int> blockInstructions;
+	DisasmLines lines;
+
+	for (int i = 0; i < locations.size(); ++i) {
+		int addr = locations[i] & 0xFFFF;
+		int slot = locations[i] >> 16;
+		quint32 n = hits.value(locations[i]);
+		const Symbol* sym = symbolBefore(syms, addr, slot);
+
+		switch (grouping) {
+		case BY_SYMBOL: {
+			int idx;
+			if (sym) {
+				idx = symbolSpots.value(sym, -1);
+			} else {
+				idx = unnamedSpots.value(slot, -1);
+			}
+			if (idx < 0) {
+				HotSpot h;
+				h.address = sym ? sym->value() : addr;
+				h.endAddress = addr;
+				h.slotKey = slot;
+				h.samples = 0;
+				h.name = sym ? sym->text() : tr("(no symbol)");
+				idx = spots.size();
+				spots.append(h);
+				if (sym) {
+					symbolSpots.insert(sym, idx);
+				} else {
+					unnamedSpots.insert(slot, idx);
+				}
+			}
+			spots[idx].samples += n;
+			spots[idx].endAddress = std::max(spots[idx].endAddress, addr);
+			break;
+		}
+		case BY_BLOCK:
+			// sampled addresses that are reached by falling through from
+			// the previous sampled instruction belong to the same block
+			if (slot == blockSlot && addr <= blockEnd &&
+			    blockInstructions.contains(addr)) {
+				spots.last().samples += n;
+				spots.last().endAddress = addr;
+				break;
+			}
+			blockEnd = -1;
+			blockSlot = -1;
+			blockInstructions.clear();
+			if (mem && symTable && ml && ml->slotKey(addr) == slot) {
+				dasm(mem, addr, std::min(addr + MAX_BLOCK_SIZE, 0xFFFF), lines,
+				     ml, symTable, 0x10000);
+				for (unsigned j = 0; j < lines.size(); ++j) {
+					// a label is a jump target and starts a new block
+					if (lines[j].rowType == DisasmRow::LABEL) {
+						if (lines[j].addr != addr) break;
+						continue;
+					}
+					blockInstructions.append(lines[j].addr);
+					blockEnd = lines[j].addr;
+					if (endsBlock(lines[j].instr)) break;
+				}
+				blockSlot = slot;
+			}
+			// fall through
+		case BY_INSTRUCTION: {
+			HotSpot h;
+			h.address = addr;
+			h.endAddress = addr;
+			h.slotKey = slot;
+			h.samples = n;
+			h.name = locationName(sym, addr);
+			spots.append(h);
+			break;
+		}
+		}
+	}
+
+	std::stable_sort(spots.begin(), spots.end(), hotter);
+	return spots;
+}
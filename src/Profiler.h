@@ -0,0 +1,79 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "OpenMSXConnection.h"
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QTimer>
+
+class SymbolTable;
+struct MemoryLayout;
+
+/** Statistical hot-spot profiler.
+  * A sampler in openMSX periodically (in emulated time) records the
+  * program counter together with the slot and segment it executes from.
+  * The samples are collected in a bounded buffer on the openMSX side and
+  * are fetched in batches, so the debugger never slows down the emulation
+  * with a round trip per sample.
+  */
+class Profiler : public QObject
+{
+	Q_OBJECT
+public:
+	Profiler(QObject* parent = 0);
+
+	enum Grouping { BY_SYMBOL, BY_BLOCK, BY_INSTRUCTION };
+
+	struct HotSpot {
+		int address;
+		int endAddress;
+		int slotKey;
+		quint32 samples;
+		QString name;
+	};
+
+	bool isRunning() const;
+	int interval() const;
+
+	quint32 totalSamples() const;
+	quint32 maxSamples() const;
+	// samples taken at addr, in the slot/segment currently mapped there
+	quint32 samplesAt(int addr, const MemoryLayout* ml) const;
+
+	/** Aggregates the samples per symbol, basic block or instruction,
+	  * sorted hottest first. Basic blocks can only be determined for code
+	  * that is currently visible in mem.
+	  */
+	QList<HotSpot> hotSpots(Grouping grouping, SymbolTable* symTable,
+	                        const unsigned char* mem, MemoryLayout* ml) const;
+
+public slots:
+	void start(int usec);
+	void stop();
+	void clear();
+	void fetch();
+
+signals:
+	void profileChanged();
+	void runningChanged(bool running);
+
+private slots:
+	void connectionClosed();
+
+private:
+	void addSamples(const QString& data);
+
+	// (slotKey << 16) | address -> number of samples
+	QHash<quint32, quint32> hits;
+	quint32 total;
+	quint32 maxHits;
+
+	int sampleInterval;
+	bool running;
+	SingleFetch fetcher;
+	QTimer fetchTimer;
+};
+
+#endif // PROFILER_H
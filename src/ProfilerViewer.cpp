@@ -0,0 +1,152 @@
+#include "ProfilerViewer.h"
+#include "Profiler.h"
+#include "Convert.h"
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+// only the hottest entries are worth showing
+static const int MAX_HOT_SPOTS = 200;
+
+ProfilerViewer::ProfilerViewer(QWidget* parent)
+	: QWidget(parent)
+{
+	startButton = new QPushButton(tr("Start"));
+	startButton->setCheckable(true);
+	clearButton = new QPushButton(tr("Clear"));
+
+	intervalEdit = new QSpinBox();
+	intervalEdit->setRange(10, 100000);
+	intervalEdit->setValue(1000);
+	intervalEdit->setSuffix(tr(" us"));
+	intervalEdit->setToolTip(tr("Sample interval in emulated time"));
+
+	groupingList = new QComboBox();
+	groupingList->addItem(tr("Per symbol"));
+	groupingList->addItem(tr("Per basic block"));
+	groupingList->addItem(tr("Per instruction"));
+
+	totalLabel = new QLabel();
+
+	hotList = new QTreeWidget();
+	hotList->setRootIsDecorated(false);
+	hotList->setColumnCount(4);
+	hotList->setHeaderLabels(QStringList() << tr("Location") << tr("Address")
+	                                       << tr("Samples") << tr("%"));
+	hotList->setSortingEnabled(true);
+	hotList->sortByColumn(2, Qt::DescendingOrder);
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->setMargin(0);
+	hbox->addWidget(startButton);
+	hbox->addWidget(intervalEdit);
+	hbox->addWidget(groupingList);
+	hbox->addWidget(clearButton);
+	hbox->addStretch();
+	hbox->addWidget(totalLabel);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->setMargin(0);
+	vbox->addLayout(hbox);
+	vbox->addWidget(hotList);
+	setLayout(vbox);
+
+	profiler = 0;
+	symTable = 0;
+	memory = 0;
+	memLayout = 0;
+
+	connect(startButton, SIGNAL(toggled(bool)), this, SLOT(startStop(bool)));
+	connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+	connect(groupingList, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+	connect(hotList, SIGNAL(itemActivated(QTreeWidgetItem*, int)),
+	        this, SLOT(itemActivated(QTreeWidgetItem*)));
+}
+
+void ProfilerViewer::setProfiler(Profiler* p)
+{
+	profiler = p;
+	connect(profiler, SIGNAL(profileChanged()), this, SLOT(refresh()));
+	connect(profiler, SIGNAL(runningChanged(bool)), this, SLOT(runningChanged(bool)));
+}
+
+void ProfilerViewer::setSymbolTable(SymbolTable* st)
+{
+	symTable = st;
+}
+
+void ProfilerViewer::setMemory(const unsigned char* mem)
+{
+	memory = mem;
+}
+
+void ProfilerViewer::setMemoryLayout(MemoryLayout* ml)
+{
+	memLayout = ml;
+}
+
+void ProfilerViewer::startStop(bool checked)
+{
+	if (!profiler || checked == profiler->isRunning()) return;
+	if (checked) {
+		profiler->start(intervalEdit->value());
+	} else {
+		profiler->stop();
+	}
+}
+
+void ProfilerViewer::runningChanged(bool running)
+{
+	startButton->setChecked(running);
+	startButton->setText(running ? tr("Stop") : tr("Start"));
+	intervalEdit->setEnabled(!running);
+}
+
+void ProfilerViewer::clear()
+{
+	if (profiler) profiler->clear();
+}
+
+void ProfilerViewer::refresh()
+{
+	if (!profiler) return;
+
+	quint32 total = profiler->totalSamples();
+	totalLabel->setText(tr("%1 samples").arg(total));
+
+	// rebuilding the list is only needed when someone looks at it
+	if (!isVisible()) return;
+
+	QList<Profiler::HotSpot> spots = profiler->hotSpots(
+		Profiler::Grouping(groupingList->currentIndex()),
+		symTable, memory, memLayout);
+
+	hotList->setSortingEnabled(false);
+	hotList->clear();
+	for (int i = 0; i < spots.size() && i < MAX_HOT_SPOTS; ++i) {
+		const Profiler::HotSpot& h = spots[i];
+		QTreeWidgetItem* item = new QTreeWidgetItem(hotList);
+		item->setText(0, h.name);
+		QString range = hexValue(h.address, 4).toUpper();
+		if (h.endAddress != h.address) {
+			range += "-" + hexValue(h.endAddress, 4).toUpper();
+		}
+		item->setText(1, range);
+		item->setData(1, Qt::UserRole, h.address);
+		// store numbers so sorting isn't alphabetical
+		item->setData(2, Qt::DisplayRole, h.samples);
+		item->setData(3, Qt::DisplayRole, 0.1 * qRound(1000.0 * h.samples / total));
+		item->setTextAlignment(2, Qt::AlignRight);
+		item->setTextAlignment(3, Qt::AlignRight);
+	}
+	hotList->setSortingEnabled(true);
+}
+
+void ProfilerViewer::itemActivated(QTreeWidgetItem* item)
+{
+	emit jumpToAddress(item->data(1, Qt::UserRole).toInt());
+}
@@ -0,0 +1,53 @@
+#ifndef PROFILERVIEWER_H
+#define PROFILERVIEWER_H
+
+#include <QWidget>
+
+class Profiler;
+class SymbolTable;
+struct MemoryLayout;
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+class ProfilerViewer : public QWidget
+{
+	Q_OBJECT
+public:
+	ProfilerViewer(QWidget* parent = 0);
+
+	void setProfiler(Profiler* p);
+	void setSymbolTable(SymbolTable* st);
+	void setMemory(const unsigned char* mem);
+	void setMemoryLayout(MemoryLayout* ml);
+
+public slots:
+	void refresh();
+
+private slots:
+	void startStop(bool checked);
+	void runningChanged(bool running);
+	void clear();
+	void itemActivated(QTreeWidgetItem* item);
+
+signals:
+	void jumpToAddress(quint16 addr);
+
+private:
+	QPushButton* startButton;
+	QPushButton* clearButton;
+	QSpinBox* intervalEdit;
+	QComboBox* groupingList;
+	QLabel* totalLabel;
+	QTreeWidget* hotList;
+
+	Profiler* profiler;
+	SymbolTable* symTable;
+	const unsigned char* memory;
+	MemoryLayout* memLayout;
+};
+
+#endif // PROFILERVIEWER_H
@@ -197,6 +197,7 @@ void SlotViewer::setMemoryLayout(MemoryLayout* ml)
 void SlotViewer::slotsUpdated(const QString& message)
 {
 	QStringList lines = message.split('\n');
+	bool changed = false;
 
 	// parse page slots and segments
 	for (int p = 0; p < 4; ++p) {
@@ -207,25 +208,26 @@ void SlotViewer::slotsUpdated(const QString& message)
 		segmentsChanged[p] = memLayout->mapperSegment[p] !=
 		                     lines[p * 2 + 1].toInt();
 		memLayout->mapperSegment[p] = lines[p * 2 + 1].toInt();
+		changed |= slotsChanged[p] || segmentsChanged[p];
 	}
 	// parse slot layout
 	int l = 8;
 	for (int ps = 0; ps < 4; ++ps) {
-		memLayout->isSubslotted[ps] = lines[l++][0] == '1';
-		if (memLayout->isSubslotted[ps]) {
-			for (int ss = 0; ss < 4; ++ss) {
-				memLayout->mapperSize[ps][ss] = lines[l++].toUShort();
-			}
-		} else {
-			memLayout->mapperSize[ps][0] = lines[l++].toUShort();
+		bool subslotted = lines[l++][0] == '1';
+		changed |= memLayout->isSubslotted[ps] != subslotted;
+		memLayout->isSubslotted[ps] = subslotted;
+		for (int ss = 0; ss < (subslotted ? 4 : 1); ++ss) {
+			int size = lines[l++].toUShort();
+			changed |= memLayout->mapperSize[ps][ss] != size;
+			memLayout->mapperSize[ps][ss] = size;
 		}
 	}
 	// parse rom blocks
 	for (int i = 0; i < 8; ++i, ++l) {
-		if (lines[l][0] == 'X')
-			memLayout->romBlock[i] = -1;
-		else
-			memLayout->romBlock[i] = lines[l].toInt();
-	}	
+		int block = lines[l][0] == 'X' ? -1 : lines[l].toInt();
+		changed |= memLayout->romBlock[i] != block;
+		memLayout->romBlock[i] = block;
+	}
 	update();
+	if (changed) emit memoryLayoutChanged();
 }
@@ -18,6 +18,10 @@ public:
 
 	QSize sizeHint() const;
 
+signals:
+	// emitted when the slots, segments or slot layout differ from before
+	void memoryLayoutChanged();
+
 private:
 	void resizeEvent(QResizeEvent* e);
 	void paintEvent(QPaintEvent* e);
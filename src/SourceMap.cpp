@@ -0,0 +1,296 @@
+#include "SourceMap.h"
+#include "DebuggerData.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <algorithm>
+
+// bits of an entry's line number, the rest holds the file number
+static const int LINE_BITS = 20;
+static const quint32 MAX_LINE = (1 << LINE_BITS) - 1;
+static const int MAX_FILES = 1 << (32 - LINE_BITS);
+// an address belongs to the line of the closest entry before it, but not
+// further away than the longest instruction
+static const int MAX_INSTRUCTION_SIZE = 4;
+
+
+SourceMap::SourceMap()
+{
+}
+
+void SourceMap::clear()
+{
+	maps.clear();
+	files.clear();
+	fileIds.clear();
+	byAddress.clear();
+	byLine.clear();
+}
+
+bool SourceMap::loadFile(const QString& filename)
+{
+	QString name = QFileInfo(filename).absoluteFilePath();
+	if (maps.contains(name)) {
+		// entries aren't tracked per file, so start over with the others
+		QStringList others = maps;
+		others.removeAll(name);
+		clear();
+		for (int i = 0; i < others.size(); ++i) {
+			loadFile(others[i]);
+		}
+	}
+
+	size_t oldSize = byAddress.size();
+	bool ok;
+	if (name.endsWith(".sld", Qt::CaseInsensitive)) {
+		ok = readSLDFile(name);
+	} else {
+		ok = readListingFile(name);
+	}
+	if (!ok || byAddress.size() == oldSize) {
+		byAddress.resize(oldSize);
+		return false;
+	}
+	maps.append(name);
+	sortEntries();
+	return true;
+}
+
+const QStringList& SourceMap::mapFiles() const
+{
+	return maps;
+}
+
+const QStringList& SourceMap::sourceFiles() const
+{
+	return files;
+}
+
+int SourceMap::lineCount() const
+{
+	return int(byLine.size());
+}
+
+int SourceMap::fileId(const QString& name)
+{
+	QHash<QString, int>::const_iterator it = fileIds.find(name);
+	if (it != fileIds.end()) return *it;
+	if (files.size() == MAX_FILES) return -1;
+	files.append(name);
+	fileIds.insert(name, files.size() - 1);
+	return files.size() - 1;
+}
+
+void SourceMap::addEntry(int file, int line, int address, int segment)
+{
+	if (file < 0 || line <= 0 || quint32(line) > MAX_LINE) return;
+	if (address < 0 || address > 0xFFFF || segment < -1 || segment >= 0xFFFF) return;
+	Entry e;
+	e.location = (quint32(segment + 1) << 16) | address;
+	e.line = (quint32(file) << LINE_BITS) | line;
+	byAddress.push_back(e);
+}
+
+void SourceMap::sortEntries()
+{
+	std::sort(byAddress.begin(), byAddress.end(),
+		[](const Entry& a, const Entry& b) {
+			return a.location < b.location ||
+			       (a.location == b.location && a.line < b.line);
+		});
+	// a line in a repeated macro or block shows up more than once
+	byAddress.erase(std::unique(byAddress.begin(), byAddress.end(),
+		[](const Entry& a, const Entry& b) {
+			return a.location == b.location && a.line == b.line;
+		}), byAddress.end());
+
+	byLine = byAddress;
+	std::sort(byLine.begin(), byLine.end(),
+		[](const Entry& a, const Entry& b) {
+			return a.line < b.line ||
+			       (a.line == b.line && a.location < b.location);
+		});
+}
+
+/* sjasmplus SLD lines are
+ *   file|line|definition file|definition line|page|value|type|data
+ * where line can be followed by :column ranges. Entries of type T mark
+ * the address of an instruction, page is -1 when the code isn't paged.
+ */
+bool SourceMap::readSLDFile(const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) return false;
+
+	// file names are relative to where the assembler ran, which usually
+	// is where it wrote the SLD file
+	QDir dir = QFileInfo(filename).absoluteDir();
+	QByteArray lastName;
+	int lastId = -1;
+	while (!file.atEnd()) {
+		QByteArray line = file.readLine();
+		// header and comment lines start with an empty file name
+		if (line.startsWith('|')) continue;
+		QList<QByteArray> fields = line.split('|');
+		if (fields.size() < 7 || fields[6] != "T") continue;
+
+		if (fields[0] != lastName) {
+			lastName = fields[0];
+			QString name = QString::fromUtf8(lastName);
+			lastId = fileId(QDir::cleanPath(dir.absoluteFilePath(name)));
+		}
+		QByteArray lineField = fields[1];
+		int colon = lineField.indexOf(':');
+		if (colon != -1) lineField.truncate(colon);
+		bool ok1, ok2, ok3;
+		int lineNr = lineField.toInt(&ok1);
+		int page = fields[4].toInt(&ok2);
+		int value = fields[5].toInt(&ok3);
+		if (!ok1 || !ok2 || !ok3) continue;
+		addEntry(lastId, lineNr, value, page < 0 ? -1 : page);
+	}
+	return true;
+}
+
+static bool isHexDigit(char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||
+	       (c >= 'a' && c <= 'f');
+}
+
+static bool isHexToken(const QByteArray& token)
+{
+	if (token.isEmpty()) return false;
+	for (int i = 0; i < token.size(); ++i) {
+		if (!isHexDigit(token[i])) return false;
+	}
+	return true;
+}
+
+// a decimal line number, optionally marked with + or ~ for the macro or
+// include nesting
+static bool isLineNumber(const QByteArray& token)
+{
+	int i = 0;
+	while (i < token.size() && token[i] >= '0' && token[i] <= '9') ++i;
+	if (i == 0) return false;
+	while (i < token.size() && (token[i] == '+' || token[i] == '~')) ++i;
+	return i == token.size();
+}
+
+/* A listing maps to its own lines, since it holds the source text. Lines
+ * with code start with an optional line number, followed by the address
+ * and the generated bytes:
+ *    12+ 8000 3E 01        ld a,1
+ *   8000 3E01              ld a,1
+ */
+bool SourceMap::readListingFile(const QString& filename)
+{
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) return false;
+
+	int id = -1;
+	int lineNr = 0;
+	while (!file.atEnd()) {
+		QByteArray line = file.readLine();
+		++lineNr;
+		QList<QByteArray> tokens = line.left(64).simplified().split(' ');
+		if (tokens.size() < 2) continue;
+
+		int addrToken = -1;
+		if (tokens.size() >= 3 && isLineNumber(tokens[0]) &&
+		    tokens[1].size() == 4 && isHexToken(tokens[1]) &&
+		    tokens[2].size() >= 2 && isHexToken(tokens[2])) {
+			addrToken = 1;
+		} else if (tokens[0].size() == 4 && isHexToken(tokens[0]) &&
+		           tokens[1].size() >= 2 && isHexToken(tokens[1])) {
+			addrToken = 0;
+		}
+		if (addrToken == -1) continue;
+		if (id == -1) id = fileId(filename);
+		addEntry(id, lineNr, tokens[addrToken].toInt(0, 16), -1);
+	}
+	return true;
+}
+
+const SourceMap::Entry* SourceMap::entryAt(int address, int segment) const
+{
+	quint32 key = (quint32(segment + 1) << 16) | address;
+	std::vector<Entry>::const_iterator it = std::upper_bound(
+		byAddress.begin(), byAddress.end(), key,
+		[](quint32 k, const Entry& e) { return k < e.location; });
+	if (it == byAddress.begin()) return 0;
+	--it;
+	if ((it->location >> 16) != (key >> 16)) return 0;
+	if (key - it->location >= quint32(MAX_INSTRUCTION_SIZE)) return 0;
+	// several lines can share an address, use the first one
+	quint32 location = it->location;
+	it = std::lower_bound(byAddress.begin(), it, location,
+		[](const Entry& e, quint32 k) { return e.location < k; });
+	return &*it;
+}
+
+bool SourceMap::findLine(int addr, const MemoryLayout* ml, int& file, int& line) const
+{
+	int segment = -1;
+	if (ml) {
+		int ps, ss;
+		ml->addressSlot(addr, ps, ss, segment);
+	}
+	const Entry* e = entryAt(addr & 0xFFFF, segment);
+	if (!e && segment != -1) e = entryAt(addr & 0xFFFF, -1);
+	if (!e) return false;
+	file = e->line >> LINE_BITS;
+	line = e->line & MAX_LINE;
+	return true;
+}
+
+QList<SourceMap::Location> SourceMap::findAddresses(int file, int line) const
+{
+	QList<Location> result;
+	if (file < 0 || line <= 0 || quint32(line) > MAX_LINE) return result;
+	quint32 key = (quint32(file) << LINE_BITS) | line;
+	std::vector<Entry>::const_iterator it = std::lower_bound(
+		byLine.begin(), byLine.end(), key,
+		[](const Entry& e, quint32 k) { return e.line < k; });
+	for (; it != byLine.end() && it->line == key; ++it) {
+		Location l;
+		l.address = it->location & 0xFFFF;
+		l.segment = int(it->location >> 16) - 1;
+		result.append(l);
+	}
+	return result;
+}
+
+int SourceMap::nextCodeLine(int file, int line) const
+{
+	if (file < 0 || line <= 0 || quint32(line) > MAX_LINE) return -1;
+	quint32 key = (quint32(file) << LINE_BITS) | line;
+	std::vector<Entry>::const_iterator it = std::lower_bound(
+		byLine.begin(), byLine.end(), key,
+		[](const Entry& e, quint32 k) { return e.line < k; });
+	if (it == byLine.end() || int(it->line >> LINE_BITS) != file) return -1;
+	return it->line & MAX_LINE;
+}
+
+void SourceMap::saveSourceMap(QXmlStreamWriter& xml) const
+{
+	for (int i = 0; i < maps.size(); ++i) {
+		xml.writeTextElement("File", maps[i]);
+	}
+}
+
+void SourceMap::loadSourceMap(QXmlStreamReader& xml)
+{
+	while (!xml.atEnd()) {
+		xml.readNext();
+		// exit if closing of main tag
+		if (xml.isEndElement() && xml.name() == "SourceMap") break;
+		// begin tag
+		if (xml.isStartElement() && xml.name() == "File") {
+			loadFile(xml.readElementText());
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#ifndef SOURCEMAP_H
+#define SOURCEMAP_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+struct MemoryLayout;
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+/** Maps addresses to the source lines they were assembled from and back.
+  * The line info comes from sjasmplus source level debug data (.sld) or
+  * from assembler listings. Both directions are kept as a sorted array of
+  * small entries, so every lookup is a binary search, whatever the size
+  * of the project.
+  */
+class SourceMap
+{
+public:
+	SourceMap();
+
+	struct Location {
+		int address;
+		// mapper or rom segment, -1 when the code isn't paged
+		int segment;
+	};
+
+	void clear();
+	// returns false when the file can't be read or holds no line info
+	bool loadFile(const QString& filename);
+	// the loaded .sld and listing files
+	const QStringList& mapFiles() const;
+	// source files the lines refer to, the index is the file number
+	const QStringList& sourceFiles() const;
+	int lineCount() const;
+
+	/** Source line of the instruction at addr, in the segment that is
+	  * mapped there in ml (or unpaged). Returns false if it's unknown.
+	  */
+	bool findLine(int addr, const MemoryLayout* ml, int& file, int& line) const;
+	// code generated from a line, empty for a line without code
+	QList<Location> findAddresses(int file, int line) const;
+	// first line at or after line that generated code, -1 if none
+	int nextCodeLine(int file, int line) const;
+
+	/* xml session file functions */
+	void saveSourceMap(QXmlStreamWriter& xml) const;
+	void loadSourceMap(QXmlStreamReader& xml);
+
+private:
+	struct Entry {
+		// ((segment + 1) << 16) | address
+		quint32 location;
+		// (file << LINE_BITS) | line
+		quint32 line;
+	};
+
+	bool readSLDFile(const QString& filename);
+	bool readListingFile(const QString& filename);
+	int fileId(const QString& name);
+	void addEntry(int file, int line, int address, int segment);
+	void sortEntries();
+	const Entry* entryAt(int address, int segment) const;
+
+	QStringList maps;
+	QStringList files;
+	QHash<QString, int> fileIds;
+	// sorted on location, then line
+	std::vector<Entry> byAddress;
+	// sorted on line, then location
+	std::vector<Entry> byLine;
+};
+
+#endif // SOURCEMAP_H
@@ -0,0 +1,284 @@
+#include "SourceViewer.h"
+#include "SourceMap.h"
+#include "DebuggerData.h"
+#include "Settings.h"
+#include <QComboBox>
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QMouseEvent>
+#include <QPlainTextDocumentLayout>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSet>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QVBoxLayout>
+
+SourceViewer::SourceViewer(QWidget* parent)
+	: QWidget(parent)
+{
+	loadButton = new QPushButton(tr("Load..."));
+	loadButton->setToolTip(tr("Load an sjasmplus .sld file or an assembler listing"));
+	fileList = new QComboBox();
+	fileList->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+	locationLabel = new QLabel();
+
+	sourceView = new QPlainTextEdit();
+	sourceView->setReadOnly(true);
+	sourceView->setLineWrapMode(QPlainTextEdit::NoWrap);
+	sourceView->setToolTip(tr("Double click a line to toggle a breakpoint on its code"));
+	sourceView->viewport()->installEventFilter(this);
+	emptyDocument = new QTextDocument(this);
+	emptyDocument->setDocumentLayout(new QPlainTextDocumentLayout(emptyDocument));
+	sourceView->setDocument(emptyDocument);
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->setMargin(0);
+	hbox->addWidget(loadButton);
+	hbox->addWidget(fileList);
+	hbox->addStretch();
+	hbox->addWidget(locationLabel);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->setMargin(0);
+	vbox->addLayout(hbox);
+	vbox->addWidget(sourceView);
+	setLayout(vbox);
+
+	srcMap = 0;
+	breaks = 0;
+	memLayout = 0;
+	shownFile = -1;
+	programCounter = -1;
+	pcFile = -1;
+	pcLine = 0;
+
+	settingsChanged();
+
+	connect(loadButton, SIGNAL(clicked()), this, SLOT(loadMapFile()));
+	connect(fileList, SIGNAL(activated(int)), this, SLOT(fileSelected(int)));
+}
+
+void SourceViewer::setSourceMap(SourceMap* map)
+{
+	srcMap = map;
+}
+
+void SourceViewer::setBreakpoints(Breakpoints* bps)
+{
+	breaks = bps;
+}
+
+void SourceViewer::setMemoryLayout(const MemoryLayout* ml)
+{
+	memLayout = ml;
+}
+
+void SourceViewer::settingsChanged()
+{
+	QFont font = Settings::get().font(Settings::CODE_FONT);
+	sourceView->setFont(font);
+	// the documents that aren't shown don't follow the font of the view
+	for (QHash<QString, QTextDocument*>::const_iterator it = documents.constBegin();
+	     it != documents.constEnd(); ++it) {
+		it.value()->setDefaultFont(font);
+	}
+}
+
+void SourceViewer::setProgramCounter(quint16 pc)
+{
+	programCounter = pc;
+	refresh();
+}
+
+void SourceViewer::refresh()
+{
+	if (!srcMap) return;
+	if (files != srcMap->sourceFiles()) updateFileList();
+
+	pcFile = -1;
+	if (programCounter >= 0 &&
+	    srcMap->findLine(programCounter, memLayout, pcFile, pcLine)) {
+		// follow the program counter into other files
+		if (pcFile != shownFile) showFile(pcFile);
+		QTextBlock block = sourceView->document()->findBlockByNumber(pcLine - 1);
+		if (block.isValid()) {
+			sourceView->setTextCursor(QTextCursor(block));
+			sourceView->centerCursor();
+		}
+		locationLabel->setText(QString("%1:%2")
+			.arg(QFileInfo(files[pcFile]).fileName()).arg(pcLine));
+	} else {
+		locationLabel->setText(programCounter >= 0 ? tr("no source for PC") : QString());
+	}
+	updateMarkers();
+}
+
+void SourceViewer::updateFileList()
+{
+	files = srcMap->sourceFiles();
+	// reread the sources with the new line info
+	clearDocuments();
+	fileList->clear();
+	for (int i = 0; i < files.size(); ++i) {
+		fileList->addItem(QFileInfo(files[i]).fileName());
+		fileList->setItemData(i, files[i], Qt::ToolTipRole);
+	}
+	// the numbers may refer to other files now
+	int file = shownFile;
+	shownFile = -1;
+	if (file >= 0 && file < files.size()) {
+		showFile(file);
+	} else if (!files.isEmpty()) {
+		showFile(0);
+	} else {
+		sourceView->setDocument(emptyDocument);
+	}
+}
+
+void SourceViewer::showFile(int file)
+{
+	fileList->setCurrentIndex(file);
+	if (file == shownFile) return;
+	shownFile = file;
+	sourceView->setDocument(fileDocument(file));
+	updateMarkers();
+}
+
+QTextDocument* SourceViewer::fileDocument(int file)
+{
+	QTextDocument*& doc = documents[files[file]];
+	if (doc) return doc;
+
+	// read once, switching files follows the program counter
+	QString text;
+	QFile f(files[file]);
+	if (f.open(QFile::ReadOnly | QFile::Text)) {
+		text = QString::fromUtf8(f.readAll());
+	} else {
+		text = tr("Cannot read %1:\n%2.").arg(files[file]).arg(f.errorString());
+	}
+	doc = new QTextDocument(this);
+	doc->setDocumentLayout(new QPlainTextDocumentLayout(doc));
+	doc->setDefaultFont(sourceView->font());
+	doc->setPlainText(text);
+	return doc;
+}
+
+void SourceViewer::clearDocuments()
+{
+	sourceView->setDocument(emptyDocument);
+	qDeleteAll(documents);
+	documents.clear();
+}
+
+void SourceViewer::fileSelected(int index)
+{
+	if (index >= 0 && index < files.size()) showFile(index);
+}
+
+// true if the code is in the segment that is mapped in
+static bool isMapped(const SourceMap::Location& l, const MemoryLayout* ml)
+{
+	if (l.segment == -1 || !ml) return true;
+	int ps, ss, segment;
+	ml->addressSlot(l.address, ps, ss, segment);
+	return segment == l.segment;
+}
+
+void SourceViewer::updateMarkers()
+{
+	QList<QTextEdit::ExtraSelection> selections;
+	if (shownFile != -1 && breaks) {
+		QTextEdit::ExtraSelection s;
+		s.format.setBackground(Qt::red);
+		s.format.setForeground(Qt::white);
+		s.format.setProperty(QTextFormat::FullWidthSelection, true);
+		// there are far fewer breakpoints than lines with code
+		QList<quint16> addrs = breaks->breakpointAddresses();
+		QSet<int> marked;
+		for (int i = 0; i < addrs.size(); ++i) {
+			int file, line;
+			if (!srcMap->findLine(addrs[i], memLayout, file, line)) continue;
+			if (file != shownFile || marked.contains(line)) continue;
+			QTextBlock block = sourceView->document()->findBlockByNumber(line - 1);
+			if (!block.isValid()) continue;
+			s.cursor = QTextCursor(block);
+			selections.append(s);
+			marked.insert(line);
+		}
+	}
+	if (pcFile != -1 && pcFile == shownFile) {
+		QTextBlock block = sourceView->document()->findBlockByNumber(pcLine - 1);
+		if (block.isValid()) {
+			QTextEdit::ExtraSelection s;
+			s.format.setBackground(QColor(255, 255, 128));
+			s.format.setProperty(QTextFormat::FullWidthSelection, true);
+			s.cursor = QTextCursor(block);
+			selections.append(s);
+		}
+	}
+	sourceView->setExtraSelections(selections);
+}
+
+bool SourceViewer::eventFilter(QObject* obj, QEvent* e)
+{
+	if (obj == sourceView->viewport() && e->type() == QEvent::MouseButtonDblClick) {
+		QMouseEvent* me = static_cast<QMouseEvent*>(e);
+		lineDoubleClicked(sourceView->cursorForPosition(me->pos()).blockNumber() + 1);
+		return true;
+	}
+	return QWidget::eventFilter(obj, e);
+}
+
+void SourceViewer::lineDoubleClicked(int line)
+{
+	if (shownFile == -1 || !isEnabled()) return;
+	// a breakpoint on a line without code goes to the next line with code
+	line = srcMap->nextCodeLine(shownFile, line);
+	if (line == -1) return;
+
+	QList<SourceMap::Location> locs = srcMap->findAddresses(shownFile, line);
+	// the breakpoint is set in the slot and segment that are mapped in, so
+	// only a copy of the code that is mapped in can get one
+	const SourceMap::Location* loc = 0;
+	for (int i = 0; i < locs.size(); ++i) {
+		if (isMapped(locs[i], memLayout)) {
+			loc = &locs[i];
+			break;
+		}
+	}
+	if (!loc) {
+		locationLabel->setText(tr("line %1 is in segment %2, which isn't mapped in")
+			.arg(line).arg(locs.first().segment));
+		return;
+	}
+	emit toggleBreakpoint(loc->address);
+	updateMarkers();
+}
+
+void SourceViewer::loadMapFile()
+{
+	if (!srcMap) return;
+	QString dir = Settings::get().value("SourceViewer/OpenDir", QDir::currentPath()).toString();
+	QString name = QFileDialog::getOpenFileName(this, tr("Load source line info"), dir,
+		tr("Source line info (*.sld *.lst *.lis *.txt);;All files (*)"));
+	if (name.isEmpty()) return;
+	Settings::get().setValue("SourceViewer/OpenDir", QFileInfo(name).absolutePath());
+
+	if (!srcMap->loadFile(name)) {
+		QMessageBox::warning(this, tr("Load source line info"),
+		                     tr("No source line info found in %1.").arg(name));
+		return;
+	}
+	// also rereads the source files, they may have changed as well
+	updateFileList();
+	refresh();
+	emit sourceMapChanged();
+}
@@ -0,0 +1,72 @@
+#ifndef SOURCEVIEWER_H
+#define SOURCEVIEWER_H
+
+#include <QWidget>
+#include <QStringList>
+#include <QHash>
+
+class SourceMap;
+class Breakpoints;
+struct MemoryLayout;
+class QComboBox;
+class QLabel;
+class QPlainTextEdit;
+class QTextDocument;
+class QPushButton;
+
+class SourceViewer : public QWidget
+{
+	Q_OBJECT
+public:
+	SourceViewer(QWidget* parent = 0);
+
+	void setSourceMap(SourceMap* map);
+	void setBreakpoints(Breakpoints* bps);
+	void setMemoryLayout(const MemoryLayout* ml);
+
+public slots:
+	void setProgramCounter(quint16 pc);
+	void refresh();
+	void settingsChanged();
+
+private slots:
+	void loadMapFile();
+	void fileSelected(int index);
+
+signals:
+	void toggleBreakpoint(int addr);
+	void sourceMapChanged();
+
+protected:
+	bool eventFilter(QObject* obj, QEvent* e);
+
+private:
+	void updateFileList();
+	void showFile(int file);
+	QTextDocument* fileDocument(int file);
+	void clearDocuments();
+	void updateMarkers();
+	void lineDoubleClicked(int line);
+
+	QPushButton* loadButton;
+	QComboBox* fileList;
+	QLabel* locationLabel;
+	QPlainTextEdit* sourceView;
+	// shown when there is no source file
+	QTextDocument* emptyDocument;
+
+	SourceMap* srcMap;
+	Breakpoints* breaks;
+	const MemoryLayout* memLayout;
+
+	// source files in fileList
+	QStringList files;
+	// the files read so far, on path
+	QHash<QString, QTextDocument*> documents;
+	int shownFile;
+	int programCounter;
+	int pcFile;
+	int pcLine;
+};
+
+#endif // SOURCEVIEWER_H
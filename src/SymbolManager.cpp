@@ -5,6 +5,7 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QHeaderView>
+#include <QSet>
 
 SymbolManager::SymbolManager(SymbolTable& symtable, QWidget* parent)
 	: QDialog(parent), symTable(symtable)
@@ -37,6 +38,8 @@ SymbolManager::SymbolManager(SymbolTable& symtable, QWidget* parent)
 	connect(btnAddFile, SIGNAL(clicked()), this, SLOT(addFile()));
 	connect(btnRemoveFile, SIGNAL(clicked()), this, SLOT(removeFile()));
 	connect(btnReloadFiles, SIGNAL(clicked()), this, SLOT(reloadFiles()));
+	connect(&symTable, SIGNAL(symbolsReloaded(const QList<int>&, const QList<Symbol*>&, const QList<Symbol*>&)),
+	        this, SLOT(symbolsReloaded(const QList<int>&, const QList<Symbol*>&, const QList<Symbol*>&)));
 	connect(treeLabels, SIGNAL(itemSelectionChanged()), this, SLOT(labelSelectionChanged()));
 	connect(treeLabels, SIGNAL(itemDoubleClicked(QTreeWidgetItem *, int)),
 	        this, SLOT(labelEdit(QTreeWidgetItem*, int)));
@@ -44,6 +47,8 @@ SymbolManager::SymbolManager(SymbolTable& symtable, QWidget* parent)
 	        this, SLOT(labelChanged(QTreeWidgetItem*, int)));
 	connect(btnAddSymbol, SIGNAL(clicked()), this, SLOT(addLabel()));
 	connect(btnRemoveSymbol, SIGNAL(clicked()), this, SLOT(removeLabel()));
+	connect(btnBreakSymbols, SIGNAL(clicked()), this, SLOT(breakLabels()));
+	connect(btnUnbreakSymbols, SIGNAL(clicked()), this, SLOT(unbreakLabels()));
 	connect(radJump, SIGNAL(toggled(bool)), this, SLOT(changeType(bool)));
 	connect(radVar, SIGNAL(toggled(bool)), this, SLOT(changeType(bool)));
 	connect(radValue, SIGNAL(toggled(bool)), this, SLOT(changeType(bool)));
@@ -86,6 +91,8 @@ SymbolManager::SymbolManager(SymbolTable& symtable, QWidget* parent)
 	groupSegments->setEnabled(false);
 	btnRemoveFile->setEnabled(false);
 	btnRemoveSymbol->setEnabled(false);
+	btnBreakSymbols->setEnabled(false);
+	btnUnbreakSymbols->setEnabled(false);
 
 	initFileList();
 	initSymbolList();
@@ -186,9 +193,9 @@ void SymbolManager::removeFile()
 
 void SymbolManager::reloadFiles()
 {
+	// the label tree is updated through symbolsReloaded()
 	symTable.reloadFiles();
 	initFileList();
-	initSymbolList();
 	emit symbolTableChanged();
 }
 
@@ -222,19 +229,46 @@ void SymbolManager::initSymbolList()
 {
 	treeLabels->clear();
 	beginTreeLabelsUpdate();
-	for (Symbol* sym = symTable.findFirstAddressSymbol(0);
-	     sym != 0;
-	     sym = symTable.findNextAddressSymbol()) {
-		QTreeWidgetItem* item = new QTreeWidgetItem(treeLabels);
-		// attach a pointer to the symbol object to the tree item
-		item->setData(0L, Qt::UserRole, quintptr(sym));
-		// update columns
-		updateItemName(item);
-		updateItemType(item);
-		updateItemValue(item);
-		updateItemSlots(item);
-		updateItemSegments(item);
-		updateItemRegisters(item);
+	for (SymbolTable::AddressIterator it = symTable.addressSymbols();
+	     !it.atEnd(); ++it) {
+		createSymbolItem(*it);
+	}
+	endTreeLabelsUpdate();
+}
+
+QTreeWidgetItem* SymbolManager::createSymbolItem(Symbol* sym)
+{
+	QTreeWidgetItem* item = new QTreeWidgetItem(treeLabels);
+	// attach a pointer to the symbol object to the tree item
+	item->setData(0L, Qt::UserRole, quintptr(sym));
+	// update columns
+	updateItemName(item);
+	updateItemType(item);
+	updateItemValue(item);
+	updateItemSlots(item);
+	updateItemSegments(item);
+	updateItemRegisters(item);
+	return item;
+}
+
+void SymbolManager::symbolsReloaded(const QList<int>& /*addresses*/,
+	const QList<Symbol*>& added, const QList<Symbol*>& changed)
+{
+	// only the items of symbols the reload touched are updated
+	beginTreeLabelsUpdate();
+	if (!changed.isEmpty()) {
+		QSet<Symbol*> dirty = changed.toSet();
+		for (int i = 0; i < treeLabels->topLevelItemCount(); ++i) {
+			QTreeWidgetItem* item = treeLabels->topLevelItem(i);
+			Symbol* sym = (Symbol*)(item->data(0, Qt::UserRole).value<quintptr>());
+			if (dirty.contains(sym)) {
+				updateItemName(item);
+				updateItemValue(item);
+			}
+		}
+	}
+	for (int i = 0; i < added.size(); ++i) {
+		createSymbolItem(added[i]);
 	}
 	endTreeLabelsUpdate();
 }
@@ -266,14 +300,7 @@ void SymbolManager::addLabel()
 	symTable.add(sym);
 
 	beginTreeLabelsUpdate();
-	QTreeWidgetItem* item = new QTreeWidgetItem(treeLabels);
-	item->setData(0, Qt::UserRole, quintptr(sym));
-	updateItemName(item);
-	updateItemType(item);
-	updateItemValue(item);
-	updateItemSlots(item);
-	updateItemSegments(item);
-	updateItemRegisters(item);
+	QTreeWidgetItem* item = createSymbolItem(sym);
 	endTreeLabelsUpdate();
 	closeEditor();
 	treeLabels->setFocus();
@@ -312,6 +339,29 @@ void SymbolManager::removeLabel()
 	}
 }
 
+QList<Symbol*> SymbolManager::selectedSymbols()
+{
+	QList<Symbol*> symbols;
+	QList<QTreeWidgetItem*> selection = treeLabels->selectedItems();
+	for (QList<QTreeWidgetItem*>::iterator selit = selection.begin();
+	     selit != selection.end(); ++selit) {
+		symbols << (Symbol*)((*selit)->data(0, Qt::UserRole).value<quintptr>());
+	}
+	return symbols;
+}
+
+void SymbolManager::breakLabels()
+{
+	QList<Symbol*> symbols = selectedSymbols();
+	if (!symbols.empty()) emit setBreakpoints(symbols);
+}
+
+void SymbolManager::unbreakLabels()
+{
+	QList<Symbol*> symbols = selectedSymbols();
+	if (!symbols.empty()) emit removeBreakpoints(symbols);
+}
+
 void SymbolManager::labelChanged(QTreeWidgetItem* item, int column)
 {
 	if (!treeLabelsUpdateCount) {
@@ -345,6 +395,8 @@ void SymbolManager::labelSelectionChanged()
 	if (selection.empty()) {
 		// disable everything
 		btnRemoveSymbol->setEnabled(false);
+		btnBreakSymbols->setEnabled(false);
+		btnUnbreakSymbols->setEnabled(false);
 		groupSlots->setEnabled(false);
 		groupSegments->setEnabled(false);
 		groupType->setEnabled(false);
@@ -387,6 +439,8 @@ void SymbolManager::labelSelectionChanged()
 	}
 
 	btnRemoveSymbol->setEnabled(removeButActive);
+	btnBreakSymbols->setEnabled(true);
+	btnUnbreakSymbols->setEnabled(true);
 	groupSlots->setEnabled(true);
 	groupType->setEnabled(true);
 	groupRegs8->setEnabled(anyEight);
@@ -548,6 +602,8 @@ void SymbolManager::updateItemName(QTreeWidgetItem* item)
 		item->setTextColor(0, QColor(128, 0, 0));
 		break;
 	default:
+		// a lost symbol can be found again on reload
+		item->setTextColor(0, treeLabels->palette().color(QPalette::Text));
 		break;
 	}
 }
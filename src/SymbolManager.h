@@ -4,6 +4,7 @@
 #include "ui_SymbolManager.h"
 
 class SymbolTable;
+class Symbol;
 class QTreeWidgetItem;
 
 class SymbolManager : public QDialog, private Ui::SymbolManager
@@ -17,6 +18,7 @@ private:
 
 	void initFileList();
 	void initSymbolList();
+	QTreeWidgetItem* createSymbolItem(Symbol* sym);
 
 	void closeEditor();
 
@@ -31,6 +33,8 @@ private:
 	void beginTreeLabelsUpdate();
 	void endTreeLabelsUpdate();
 
+	QList<Symbol*> selectedSymbols();
+
 	SymbolTable& symTable;
 	int treeLabelsUpdateCount;
 	QCheckBox* chkSlots[16];
@@ -43,8 +47,13 @@ private slots:
 	void addFile();
 	void removeFile();
 	void reloadFiles();
+	void symbolsReloaded(const QList<int>& addresses,
+	                     const QList<Symbol*>& added,
+	                     const QList<Symbol*>& changed);
 	void addLabel();
 	void removeLabel();
+	void breakLabels();
+	void unbreakLabels();
 	void labelEdit(QTreeWidgetItem* item, int column);
 	void labelChanged(QTreeWidgetItem* item, int column);
 	void labelSelectionChanged();
@@ -88,6 +97,8 @@ private slots:
 
 signals:
 	void symbolTableChanged();
+	void setBreakpoints(const QList<Symbol*>& symbols);
+	void removeBreakpoints(const QList<Symbol*>& symbols);
 };
 
 #endif // SYMBOLMANAGER_OPENMSX_H
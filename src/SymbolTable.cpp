@@ -1,17 +1,31 @@
 #include "SymbolTable.h"
 #include "DebuggerData.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QStringList>
-#include <QRegExp>
 #include <QFileInfo>
 #include <QXmlStreamWriter>
 #include <QMap>
+#include <QDir>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <cstring>
 
 // class SymbolTable
 
 SymbolTable::SymbolTable()
 {
+	completionIndexValid = false;
+	visibleLayout = 0;
+	visibleValid = false;
 	connect(&fileWatcher, SIGNAL(fileChanged(const QString&)), this, SLOT(fileChanged(const QString&)));
 }
 
@@ -27,6 +41,44 @@ void SymbolTable::add(Symbol* symbol)
 	mapSymbol(symbol);
 }
 
+void SymbolTable::addSymbols(const std::vector<Symbol*>& list)
+{
+	// append the new labels to the index unsorted and merge them in one
+	// go, instead of moving the tail of the index for every single one
+	std::vector<IndexEntry>::size_type oldSize = addressIndex.size();
+	addressIndex.reserve(oldSize + list.size());
+	symbols.reserve(symbols.size() + int(list.size()));
+	indexKeys.reserve(indexKeys.size() + int(list.size()));
+	for (unsigned i = 0; i < list.size(); ++i) {
+		symbols.append(list[i]);
+		list[i]->table = this;
+		mapSymbol(list[i], false);
+	}
+	auto valueLess = [](const IndexEntry& a, const IndexEntry& b) {
+		return a.value < b.value;
+	};
+	std::stable_sort(addressIndex.begin() + oldSize, addressIndex.end(), valueLess);
+	std::inplace_merge(addressIndex.begin(), addressIndex.begin() + oldSize,
+	                   addressIndex.end(), valueLess);
+}
+
+void SymbolTable::rebuildIndex()
+{
+	addressIndex.clear();
+	valueSymbols.clear();
+	nameSymbols.clear();
+	foldedNameSymbols.clear();
+	indexKeys.clear();
+	for (QList<Symbol*>::iterator it = symbols.begin();
+	     it != symbols.end(); ++it) {
+		mapSymbol(*it, false);
+	}
+	std::stable_sort(addressIndex.begin(), addressIndex.end(),
+		[](const IndexEntry& a, const IndexEntry& b) {
+			return a.value < b.value;
+		});
+}
+
 void SymbolTable::removeAt(int index)
 {
 	Symbol* symbol = symbols.takeAt(index);
@@ -43,8 +95,16 @@ void SymbolTable::remove(Symbol* symbol)
 
 void SymbolTable::clear()
 {
-	addressSymbols.clear();
+	addressIndex.clear();
 	valueSymbols.clear();
+	nameSymbols.clear();
+	foldedNameSymbols.clear();
+	completionIndex.clear();
+	completionIndexValid = false;
+	indexKeys.clear();
+	visibleIndex.clear();
+	visibleValueSymbols.clear();
+	visibleValid = false;
 	qDeleteAll(symbols);
 	symbols.clear();
 }
@@ -54,28 +114,67 @@ int SymbolTable::size() const
 	return symbols.size();
 }
 
-void SymbolTable::mapSymbol(Symbol* symbol)
+std::vector<SymbolTable::IndexEntry>::const_iterator SymbolTable::firstAddressEntry(int addr) const
+{
+	return std::lower_bound(addressIndex.begin(), addressIndex.end(), addr,
+		[](const IndexEntry& e, int value) { return e.value < value; });
+}
+
+void SymbolTable::mapSymbol(Symbol* symbol, bool keepSorted)
 {
-	if (symbol->type() != Symbol::VALUE) {
-		addressSymbols.insert(symbol->value(), symbol);
+	IndexKey key = { symbol->value(), symbol->type(), symbol->text() };
+	if (key.type != Symbol::VALUE) {
+		IndexEntry entry = { key.value, symbol };
+		if (keepSorted) {
+			// behind the labels that already have this value
+			addressIndex.insert(std::upper_bound(
+				addressIndex.begin(), addressIndex.end(), key.value,
+				[](int value, const IndexEntry& e) { return value < e.value; }),
+				entry);
+		} else {
+			addressIndex.push_back(entry);
+		}
+		mapName(symbol);
 	}
-	if (symbol->type() != Symbol::JUMPLABEL) {
-		valueSymbols.insert(symbol->value(), symbol);
+	if (key.type != Symbol::JUMPLABEL) {
+		valueSymbols.insert(key.value, symbol);
 	}
+	indexKeys.insert(symbol, key);
+	visibleValid = false;
 }
 
 void SymbolTable::unmapSymbol(Symbol* symbol)
 {
-	QMutableMapIterator<int, Symbol*> i(addressSymbols);
-	while (i.hasNext()) {
-		i.next();
-		if (i.value() == symbol) i.remove();
+	QHash<const Symbol*, IndexKey>::iterator it = indexKeys.find(symbol);
+	if (it == indexKeys.end()) return;
+
+	if (it->type != Symbol::VALUE) {
+		std::vector<IndexEntry>::const_iterator e = firstAddressEntry(it->value);
+		while (e != addressIndex.end() && e->symbol != symbol) ++e;
+		if (e != addressIndex.end()) {
+			addressIndex.erase(addressIndex.begin() + (e - addressIndex.cbegin()));
+		}
+		unmapName(it->text, symbol);
 	}
-	QMutableHashIterator<int, Symbol*> j(valueSymbols);
-	while (j.hasNext()) {
-		j.next();
-		if (j.value() == symbol) j.remove();
+	if (it->type != Symbol::JUMPLABEL) {
+		valueSymbols.remove(it->value, symbol);
 	}
+	indexKeys.erase(it);
+	visibleValid = false;
+}
+
+void SymbolTable::mapName(Symbol* symbol)
+{
+	nameSymbols.insert(symbol->text(), symbol);
+	foldedNameSymbols.insert(symbol->text().toCaseFolded(), symbol);
+	completionIndexValid = false;
+}
+
+void SymbolTable::unmapName(const QString& name, Symbol* symbol)
+{
+	nameSymbols.remove(name, symbol);
+	foldedNameSymbols.remove(name.toCaseFolded(), symbol);
+	completionIndexValid = false;
 }
 
 void SymbolTable::symbolTypeChanged(Symbol* symbol)
@@ -90,37 +189,78 @@ void SymbolTable::symbolValueChanged(Symbol* symbol)
 	mapSymbol(symbol);
 }
 
-Symbol* SymbolTable::findFirstAddressSymbol(int addr, MemoryLayout* ml)
+void SymbolTable::symbolTextChanged(Symbol* symbol)
 {
-	for (currentAddress = addressSymbols.begin();
-	     currentAddress != addressSymbols.end(); ++currentAddress) {
-		if ((*currentAddress)->value() >= addr) {
-			if ((*currentAddress)->isSlotValid(ml)) {
-				return *currentAddress;
-			}
-		}
+	// only the name indices are affected, the label keeps its place
+	QHash<const Symbol*, IndexKey>::iterator it = indexKeys.find(symbol);
+	if (it == indexKeys.end()) return;
+
+	if (it->type != Symbol::VALUE) {
+		unmapName(it->text, symbol);
+		mapName(symbol);
 	}
-	return 0;
+	it->text = symbol->text();
+}
+
+void SymbolTable::symbolSlotsChanged(Symbol* /*symbol*/)
+{
+	visibleValid = false;
 }
 
-Symbol* SymbolTable::getCurrentAddressSymbol()
+void SymbolTable::setMemoryLayout(const MemoryLayout* ml)
 {
-	return currentAddress != addressSymbols.end() ? *currentAddress : 0;
+	visibleLayout = ml;
+	visibleValid = false;
 }
 
-Symbol* SymbolTable::findNextAddressSymbol(MemoryLayout* ml)
+void SymbolTable::layoutChanged()
 {
-	for (++currentAddress; currentAddress != addressSymbols.end();
-	     ++currentAddress) {
-		if ((*currentAddress)->isSlotValid(ml)) {
-			return *currentAddress;
+	visibleValid = false;
+}
+
+bool SymbolTable::useVisibleSymbols(const MemoryLayout* ml) const
+{
+	if (!ml || ml != visibleLayout) return false;
+	if (visibleValid) return true;
+
+	visibleIndex.clear();
+	for (std::vector<IndexEntry>::const_iterator it = addressIndex.begin();
+	     it != addressIndex.end(); ++it) {
+		if (it->symbol->isSlotValid(ml)) visibleIndex.push_back(*it);
+	}
+	visibleValueSymbols.clear();
+	for (QMultiHash<int, Symbol*>::const_iterator it = valueSymbols.begin();
+	     it != valueSymbols.end(); ++it) {
+		if (it.value()->isSlotValid(ml)) {
+			visibleValueSymbols.insert(it.key(), it.value());
 		}
 	}
-	return 0;
+	visibleValid = true;
+	return true;
+}
+
+SymbolTable::AddressIterator SymbolTable::addressSymbols(int addr, const MemoryLayout* ml) const
+{
+	// everything in the visible list is known to match the layout
+	bool visible = useVisibleSymbols(ml);
+	const std::vector<IndexEntry>& index = visible ? visibleIndex : addressIndex;
+	std::vector<IndexEntry>::const_iterator pos = std::lower_bound(
+		index.begin(), index.end(), addr,
+		[](const IndexEntry& e, int value) { return e.value < value; });
+	const IndexEntry* first = index.data();
+	return AddressIterator(first + (pos - index.begin()),
+	                       first + index.size(), visible ? 0 : ml);
 }
 
 Symbol* SymbolTable::getValueSymbol(int val, Symbol::Register reg, MemoryLayout* ml)
 {
+	if (useVisibleSymbols(ml)) {
+		for (QMultiHash<int, Symbol*>::const_iterator it = visibleValueSymbols.find(val);
+		     it != visibleValueSymbols.end() && it.key() == val; ++it) {
+			if (it.value()->validRegisters() & reg) return it.value();
+		}
+		return 0;
+	}
 	for (QMultiHash<int, Symbol*>::iterator it = valueSymbols.find(val);
 	     it != valueSymbols.end() && it.key() == val; ++it) {
 		if ((it.value()->validRegisters() & reg) &&
@@ -133,36 +273,119 @@ Symbol* SymbolTable::getValueSymbol(int val, Symbol::Register reg, MemoryLayout*
 
 Symbol* SymbolTable::getAddressSymbol(int addr, MemoryLayout* ml)
 {
-	for (QMultiMap<int, Symbol*>::iterator it = addressSymbols.find(addr);
-	     it != addressSymbols.end() && it.key() == addr; ++it) {
-		if (it.value()->isSlotValid(ml)) {
-			return it.value();
+	if (useVisibleSymbols(ml)) {
+		AddressIterator it = addressSymbols(addr, ml);
+		return (!it.atEnd() && it->value() == addr) ? *it : 0;
+	}
+	for (std::vector<IndexEntry>::const_iterator it = firstAddressEntry(addr);
+	     it != addressIndex.end() && it->value == addr; ++it) {
+		if (it->symbol->isSlotValid(ml)) {
+			return it->symbol;
 		}
 	}
 	return 0;
 }
 
+// of the labels with the same name, the one with the lowest address
+static Symbol* lowestSymbol(const QMultiHash<QString, Symbol*>& names,
+                            const QString& name)
+{
+	Symbol* symbol = 0;
+	for (QMultiHash<QString, Symbol*>::const_iterator it = names.find(name);
+	     it != names.end() && it.key() == name; ++it) {
+		if (!symbol || it.value()->value() < symbol->value()) {
+			symbol = it.value();
+		}
+	}
+	return symbol;
+}
+
 Symbol* SymbolTable::getAddressSymbol(const QString& label, bool case_sensitive)
 {
-	for (QMultiMap<int, Symbol*>::iterator it = addressSymbols.begin();
-	     it != addressSymbols.end(); ++it) {
-		if (it.value()->text().compare(label, Qt::CaseSensitive)==0)
-			return it.value();
-		if (!case_sensitive && it.value()->text().compare(label, Qt::CaseInsensitive)==0)
-			return it.value();
+	// an exact match wins over one that only differs in case
+	Symbol* symbol = lowestSymbol(nameSymbols, label);
+	if (!symbol && !case_sensitive) {
+		symbol = lowestSymbol(foldedNameSymbols, label.toCaseFolded());
 	}
-	return 0;
+	return symbol;
+}
+
+void SymbolTable::updateCompletionIndex() const
+{
+	if (completionIndexValid) return;
+
+	// sorting once per change beats keeping the index sorted while a
+	// whole symbol file is added
+	completionIndex.clear();
+	completionIndex.reserve(addressIndex.size());
+	for (std::vector<IndexEntry>::const_iterator it = addressIndex.begin();
+	     it != addressIndex.end(); ++it) {
+		CompletionEntry entry = { it->symbol->text().toCaseFolded(), it->symbol };
+		completionIndex.push_back(entry);
+	}
+	std::sort(completionIndex.begin(), completionIndex.end(),
+		[](const CompletionEntry& a, const CompletionEntry& b) {
+			return a.folded < b.folded;
+		});
+	completionIndexValid = true;
 }
 
-QStringList SymbolTable::labelList(bool include_vars, const MemoryLayout* ml) const
+// how well name matches text, lower is better and -1 is no match
+static int matchScore(const QString& name, const QString& text)
 {
+	int pos = name.indexOf(text);
+	if (pos >= 0) return pos;
+
+	// the characters of text in order, the closer together the better
+	int first = -1;
+	int i = 0;
+	for (int j = 0; j < text.size(); ++j, ++i) {
+		i = name.indexOf(text[j], i);
+		if (i < 0) return -1;
+		if (first < 0) first = i;
+	}
+	return name.size() + i - first;
+}
+
+QStringList SymbolTable::labelCompletions(const QString& text, int maxCount,
+	bool include_vars, const MemoryLayout* ml) const
+{
+	updateCompletionIndex();
+	QString folded = text.toCaseFolded();
+	auto accepted = [&](const Symbol* s) {
+		return (s->type() == Symbol::JUMPLABEL ||
+		        (include_vars && s->type() == Symbol::VARIABLELABEL)) &&
+		       s->isSlotValid(ml);
+	};
+
+	// names starting with text are a contiguous range of the index
 	QStringList labels;
-	for (QMultiMap<int, Symbol*>::const_iterator it = addressSymbols.begin();
-	     it != addressSymbols.end(); ++it) 
-	{
-		if (it.value()->type() == Symbol::JUMPLABEL || (include_vars && it.value()->type() == Symbol::VARIABLELABEL ) )
-			if( ml == 0 || it.value()->isSlotValid(ml) )
-				labels << it.value()->text();
+	std::vector<CompletionEntry>::const_iterator it = std::lower_bound(
+		completionIndex.begin(), completionIndex.end(), folded,
+		[](const CompletionEntry& e, const QString& s) { return e.folded < s; });
+	for (; it != completionIndex.end() && labels.size() < maxCount &&
+	       it->folded.startsWith(folded); ++it) {
+		if (accepted(it->symbol) && !labels.contains(it->symbol->text())) {
+			labels << it->symbol->text();
+		}
+	}
+	if (labels.size() >= maxCount || folded.isEmpty()) return labels;
+
+	// rank the other names on how well they match, the index position
+	// keeps names with the same score in alphabetical order
+	std::vector<std::pair<int, int> > matches;
+	for (unsigned i = 0; i < completionIndex.size(); ++i) {
+		const CompletionEntry& e = completionIndex[i];
+		if (e.folded.startsWith(folded)) continue;
+		int score = matchScore(e.folded, folded);
+		if (score >= 0 && accepted(e.symbol)) {
+			matches.push_back(std::make_pair(score, int(i)));
+		}
+	}
+	std::sort(matches.begin(), matches.end());
+	for (unsigned i = 0; i < matches.size() && labels.size() < maxCount; ++i) {
+		const QString& name = completionIndex[matches[i].second].symbol->text();
+		if (!labels.contains(name)) labels << name;
 	}
 	return labels;
 }
@@ -221,21 +444,35 @@ bool SymbolTable::readFile(const QString& filename, FileType type)
 			}
 		}
 	}
+
+	std::vector<Symbol*> list;
+	if (!readSymbols(filename, type, list)) {
+		qDeleteAll(list.begin(), list.end());
+		return false;
+	}
+	appendFile(filename, type);
+	addFileSymbols(list);
+	return true;
+}
+
+bool SymbolTable::readSymbols(const QString& filename, FileType type,
+                              std::vector<Symbol*>& list)
+{
 	switch (type) {
 	case TNIASM0_FILE:
-		return readTNIASM0File(filename);
+		return readTNIASM0File(filename, list);
 	case TNIASM1_FILE:
-		return readTNIASM1File(filename);
+		return readTNIASM1File(filename, list);
 	case SJASM_FILE:
-		return readSJASMFile(filename);
+		return readSJASMFile(filename, list);
 	case ASMSX_FILE:
-		return readASMSXFile(filename);
+		return readASMSXFile(filename, list);
 	case HTC_FILE:
-		return readHTCFile(filename);
+		return readHTCFile(filename, list);
 	case LINKMAP_FILE:
-		return readLinkMapFile(filename);
+		return readLinkMapFile(filename, list);
 	case PASMO_FILE:
-		return readPASMOFile(filename);
+		return readPASMOFile(filename, list);
 	default:
 		return false;
 	}
@@ -251,6 +488,146 @@ void SymbolTable::appendFile(const QString& file, FileType type)
 	fileWatcher.addPath(file);
 }
 
+// The contents of a symbol file, mapped into memory when possible. The
+// readers below work on the raw bytes instead of decoding every line
+// into a QString first.
+class SymbolFileData
+{
+public:
+	bool open(const QString& filename)
+	{
+		file.setFileName(filename);
+		if (!file.open(QIODevice::ReadOnly)) return false;
+		qint64 size = file.size();
+		const char* data = (size > 0)
+			? reinterpret_cast<const char*>(file.map(0, size)) : 0;
+		if (!data) {
+			buffer = file.readAll();
+			data = buffer.constData();
+			size = buffer.size();
+		}
+		first = data;
+		last = data + size;
+		return true;
+	}
+
+	const char* begin() const { return first; }
+	const char* end() const { return last; }
+
+private:
+	QFile file;
+	QByteArray buffer;
+	const char* first;
+	const char* last;
+};
+
+// creates the symbol described by a single line, or returns 0
+typedef std::function<Symbol*(const char* first, const char* last)> LineParser;
+
+// files smaller than this aren't worth splitting up
+static const int MIN_CHUNK_SIZE = 256 * 1024;
+
+static void parseLines(const char* pos, const char* end,
+                       const LineParser& parse, std::vector<Symbol*>& result)
+{
+	while (pos != end) {
+		const char* eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if (!eol) eol = end;
+		const char* last = eol;
+		if (last != pos && last[-1] == '\r') --last;
+		if (Symbol* sym = parse(pos, last)) result.push_back(sym);
+		pos = (eol == end) ? end : eol + 1;
+	}
+}
+
+class ParseChunkTask : public QRunnable
+{
+public:
+	ParseChunkTask(const char* first_, const char* last_, const LineParser& parse_)
+		: first(first_), last(last_), parse(parse_)
+	{
+		setAutoDelete(false);
+	}
+
+	virtual void run()
+	{
+		parseLines(first, last, parse, result);
+	}
+
+	std::vector<Symbol*> result;
+
+private:
+	const char* first;
+	const char* last;
+	const LineParser& parse;
+};
+
+// Big files are cut into chunks of whole lines that are parsed in
+// parallel. The symbols are returned in file order.
+static std::vector<Symbol*> parseFile(const SymbolFileData& data,
+                                      const LineParser& parse)
+{
+	std::vector<Symbol*> result;
+	const char* begin = data.begin();
+	const char* end = data.end();
+	int chunks = std::min<qint64>(QThread::idealThreadCount(),
+	                              (end - begin) / MIN_CHUNK_SIZE);
+	if (chunks <= 1) {
+		parseLines(begin, end, parse, result);
+		return result;
+	}
+
+	QThreadPool pool;
+	std::vector<ParseChunkTask*> tasks;
+	const char* pos = begin;
+	for (int i = 0; i < chunks; ++i) {
+		const char* last = end;
+		if (i != chunks - 1) {
+			last = std::max(pos, begin + (end - begin) / chunks * (i + 1));
+			const char* eol = static_cast<const char*>(memchr(last, '\n', end - last));
+			last = eol ? eol + 1 : end;
+		}
+		tasks.push_back(new ParseChunkTask(pos, last, parse));
+		pool.start(tasks.back());
+		pos = last;
+	}
+	pool.waitForDone();
+
+	for (unsigned i = 0; i < tasks.size(); ++i) {
+		result.insert(result.end(), tasks[i]->result.begin(), tasks[i]->result.end());
+		delete tasks[i];
+	}
+	return result;
+}
+
+static bool isSpace(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+static bool parseDigits(const char* p, const char* end, int base, int& result)
+{
+	if (p == end) return false;
+	qint64 value = 0;
+	for (; p != end; ++p) {
+		int digit;
+		if (*p >= '0' && *p <= '9') {
+			digit = *p - '0';
+		} else if (*p >= 'a' && *p <= 'z') {
+			digit = *p - 'a' + 10;
+		} else if (*p >= 'A' && *p <= 'Z') {
+			digit = *p - 'A' + 10;
+		} else {
+			return false;
+		}
+		if (digit >= base) return false;
+		value = value * base + digit;
+		if (value > 0x7FFFFFFF) return false;
+	}
+	result = int(value);
+	return true;
+}
+
 // Universal value parsing routine. Accepts:
 //  - 0123h, 1234h, 1234H  (hex)
 //  - 0x1234               (hex)
@@ -258,202 +635,311 @@ void SymbolTable::appendFile(const QString& file, FileType type)
 //  - 0123                 (oct)
 // The string may (optionally) end with a '; comment' part (with or without
 // whitespace around the ';' character).
-static bool parseValue(const QString& str, int& result)
-{
-	QStringList l = str.split(";"); // ignore stuff after ';'
-	QString s = l.at(0).trimmed();
-	bool success;
-	if (s.endsWith('h', Qt::CaseInsensitive)) {
-		s.chop(1);
-		result = s.toInt(&success, 16);
+static bool parseValue(const char* p, const char* end, int& result)
+{
+	const char* comment = static_cast<const char*>(memchr(p, ';', end - p));
+	if (comment) end = comment;
+	while (p != end && isSpace(*p)) ++p;
+	while (p != end && isSpace(end[-1])) --end;
+
+	bool negative = false;
+	if (p != end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+	int base = 10;
+	if (p != end && (end[-1] == 'h' || end[-1] == 'H')) {
+		base = 16;
+		--end;
+	} else if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+		base = 16;
+		p += 2;
+	} else if (end - p > 1 && p[0] == '0') {
+		base = 8;
+	}
+	if (!parseDigits(p, end, base, result)) return false;
+	if (negative) result = -result;
+	return true;
+}
+
+// "label: equ value" lines, the separator differs per assembler
+static Symbol* parseEquLine(const char* p, const char* end, const QByteArray& equ)
+{
+	const char* sep = std::search(p, end, equ.begin(), equ.end());
+	if (sep == end) return 0;
+	const char* rest = sep + equ.size();
+	// the separator should occur only once
+	if (std::search(rest, end, equ.begin(), equ.end()) != end) return 0;
+	int value;
+	if (!parseValue(rest, end, value)) return 0;
+	return new Symbol(QString::fromUtf8(p, sep - p), value);
+}
+
+// "label hexvalue psect" lines
+static Symbol* parseHTCLine(const char* p, const char* end)
+{
+	const char* s1 = static_cast<const char*>(memchr(p, ' ', end - p));
+	if (!s1) return 0;
+	const char* s2 = static_cast<const char*>(memchr(s1 + 1, ' ', end - s1 - 1));
+	if (!s2 || memchr(s2 + 1, ' ', end - s2 - 1)) return 0;
+	int value;
+	if (!parseDigits(s1 + 1, s2, 16, value)) return 0;
+	return new Symbol(QString::fromUtf8(p, s1 - p), value);
+}
+
+// "label EQU 0C000H" lines, with any amount of spaces or tabs in between
+static Symbol* parsePASMOLine(const char* p, const char* end)
+{
+	const char* fields[3][2];
+	int n = 0;
+	while (true) {
+		const char* e = p;
+		while (e != end && !isSpace(*e)) ++e;
+		if (n == 3) return 0;
+		fields[n][0] = p;
+		fields[n][1] = e;
+		++n;
+		if (e == end) break;
+		p = e;
+		while (p != end && isSpace(*p)) ++p;
+	}
+	if (n != 3) return 0;
+	// at most five hex digits, anything that isn't one means 0
+	int value = 0;
+	if (!parseDigits(fields[2][0], std::min(fields[2][0] + 5, fields[2][1]), 16, value)) {
+		value = 0;
+	}
+	return new Symbol(QString::fromUtf8(fields[0][0], fields[0][1] - fields[0][0]), value);
+}
+
+static bool startsWith(const char* p, const char* end, const char* prefix)
+{
+	int size = int(strlen(prefix));
+	return end - p >= size && memcmp(p, prefix, size) == 0;
+}
+
+// "$4000 label", "4000h label" or "00:4000h label" (megarom page) lines
+// in the "; global and local" section
+static Symbol* parseASMSXLine(const char* p, const char* end, int& filePart)
+{
+	// the positions that are tested can be past the end of a short line
+	auto at = [p, end](int i) { return i < end - p ? p[i] : '\0'; };
+	if (at(0) == ';') {
+		if (startsWith(p, end, "; global and local")) {
+			filePart = 1;
+		} else if (startsWith(p, end, "; other")) {
+			filePart = 2;
+		}
+		return 0;
+	}
+	if (filePart != 1) return 0;
+	if (at(0) != '$' && at(4) != 'h' && at(5) != 'h' && at(8) != 'h') return 0;
+
+	const char* s1 = static_cast<const char*>(memchr(p, ' ', end - p));
+	if (!s1) return 0;
+	const char* name = s1 + 1;
+	const char* nameEnd = static_cast<const char*>(memchr(name, ' ', end - name));
+	if (!nameEnd) nameEnd = end;
+	while (name != nameEnd && isSpace(*name)) ++name;
+	while (name != nameEnd && isSpace(nameEnd[-1])) --nameEnd;
+
+	// the last four digits before the 'h' or the end of the value, a
+	// value that doesn't parse is 0
+	const char* first;
+	const char* last;
+	if (at(0) == '$') {
+		first = std::max(p, s1 - 4);
+		last = s1;
+	} else if (at(4) == 'h' || at(5) == 'h') {
+		last = static_cast<const char*>(memchr(p, 'h', s1 - p));
+		if (!last) last = p;
+		first = std::max(p, last - 4);
 	} else {
-		result = s.toInt(&success, 0); // any base (e.g. 0x..)
+		const char* colon = static_cast<const char*>(memchr(p, ':', s1 - p));
+		if (!colon) return 0;
+		first = colon + 1;
+		last = static_cast<const char*>(memchr(first, ':', s1 - first));
+		if (!last) last = s1;
+		last = std::min(last, first + 4);
+	}
+	int value;
+	if (!parseDigits(first, last, 16, value)) value = 0;
+	return new Symbol(QString::fromUtf8(name, nameEnd - name), value);
+}
+
+// " 4000  " at p, followed by the end of the line or a column that doesn't
+// start with a space or a digit
+static bool isLinkMapAddress(const char* p, const char* end)
+{
+	if (end - p < 7 || p[0] != ' ' || p[5] != ' ' || p[6] != ' ') return false;
+	for (int i = 1; i < 5; ++i) {
+		if (!isxdigit(static_cast<unsigned char>(p[i]))) return false;
+	}
+	return p + 7 == end || (p[7] != ' ' && (p[7] < '0' || p[7] > '9'));
+}
+
+// "label psect 4000  " column of a symbol table line, the psect may be blank
+static Symbol* parseLinkMapColumn(const char* p, const char* end)
+{
+	if (end - p < 8 || end[-1] != ' ' || end[-2] != ' ' || end[-7] != ' ') return 0;
+	const char* addr = end - 6;
+	int value;
+	if (!parseDigits(addr, end - 2, 16, value)) return 0;
+	const char* name = p;
+	while (name != addr && *name != ' ') ++name;
+	if (name == p) return 0;
+	const char* q = name;
+	while (q != addr && *q == ' ') ++q;
+	while (q != addr && *q != ' ') ++q;
+	while (q != addr && *q == ' ') ++q;
+	if (q != addr) return 0;
+	return new Symbol(QString::fromUtf8(p, name - p), value);
+}
+
+static void parseLinkMapLine(const char* p, const char* end, std::vector<Symbol*>& list)
+{
+	if (p == end) return;
+	QByteArray line(p, int(end - p));
+	line += "  ";
+	const char* b = line.constData();
+	const char* e = b + line.size();
+	int len = line.size();
+
+	// HiTech uses multiple columns of non-fixed width and a column for
+	// psect may be blank, so the address may be the first or second match.
+	// All columns have the width up to the end of the first address.
+	int width = 0;
+	int pos = 0;
+	bool ok = false;
+	for (int tries = 0; (tries < 2) && !ok; ++tries) {
+		while (pos + 7 <= len && !isLinkMapAddress(b + pos, e)) ++pos;
+		if (pos + 7 > len) return;
+		width = pos + 7;
+		if ((len % width) == 0) {
+			ok = true;
+			for (int posn = pos + width; (posn < len) && ok; posn += width) {
+				ok = isLinkMapAddress(b + posn, e);
+			}
+		}
+		pos = width - 1;
+	}
+	if (!ok) return;
+
+	for (pos = 0; pos < len; pos += width) {
+		if (Symbol* sym = parseLinkMapColumn(b + pos, b + pos + width)) {
+			list.push_back(sym);
+		}
+	}
+}
+
+void SymbolTable::addFileSymbols(std::vector<Symbol*>& list)
+{
+	for (unsigned i = 0; i < list.size(); ++i) {
+		list[i]->setSource(&symbolFiles.back().fileName);
 	}
-	return success;
+	addSymbols(list);
 }
 
 bool SymbolTable::readSymbolFile(
-	const QString& filename, FileType type, const QString& equ)
+	const QString& filename, const QString& equ, std::vector<Symbol*>& list)
 {
-	QFile file(filename);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	SymbolFileData data;
+	if (!data.open(filename)) {
 		return false;
 	}
 
-	appendFile(filename, type);
-	QTextStream in(&file);
-	while (!in.atEnd()) {
-		QString line = in.readLine();
-		QStringList l = line.split(equ);
-		if (l.size() != 2) continue;
-		int value;
-		if (!parseValue(l.at(1), value)) continue;
-		Symbol* sym = new Symbol(l.at(0), value);
-		sym->setSource(&symbolFiles.back().fileName);
-		add(sym);
-	}
+	QByteArray sep = equ.toUtf8();
+	list = parseFile(data,
+		[&sep](const char* first, const char* last) {
+			return parseEquLine(first, last, sep);
+		});
 	return true;
 }
-bool SymbolTable::readTNIASM0File(const QString& filename)
+bool SymbolTable::readTNIASM0File(const QString& filename, std::vector<Symbol*>& list)
 {
-	return readSymbolFile(filename, TNIASM0_FILE, ": equ ");
+	return readSymbolFile(filename, ": equ ", list);
 }
-bool SymbolTable::readTNIASM1File(const QString& filename)
+bool SymbolTable::readTNIASM1File(const QString& filename, std::vector<Symbol*>& list)
 {
-	return readSymbolFile(filename, TNIASM1_FILE, ": %equ ");
+	return readSymbolFile(filename, ": %equ ", list);
 }
-bool SymbolTable::readSJASMFile(const QString& filename)
+bool SymbolTable::readSJASMFile(const QString& filename, std::vector<Symbol*>& list)
 {
-	return readSymbolFile(filename, SJASM_FILE, ": equ ");
+	return readSymbolFile(filename, ": equ ", list);
 }
 
-bool SymbolTable::readASMSXFile(const QString& filename)
+bool SymbolTable::readASMSXFile(const QString& filename, std::vector<Symbol*>& list)
 {
-	QFile file( filename );
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	SymbolFileData data;
+	if (!data.open(filename)) {
 		return false;
 	}
 
-	appendFile(filename, ASMSX_FILE);
-	QTextStream in(&file);
+	// the section comments switch the meaning of the lines after them, so
+	// the file is parsed in one piece
 	int filePart = 0;
-	while (!in.atEnd()) {
-		QString line = in.readLine();
-		if (line[0] == ';') {
-			if (line.startsWith("; global and local")) {
-				filePart = 1;
-			} else if (line.startsWith("; other")) {
-				filePart = 2;
-			}
-		} else {
-			if ((line[0] == '$') || (line[4] == 'h') ||
-			    (line[5] == 'h') || (line[8] == 'h')) {
-				if (filePart == 1) {
-					QStringList l = line.split(" ");
-					Symbol* sym;
-					if (line[0] == '$') {
-						sym = new Symbol(l.at(1).trimmed(), l.at(0).right(4).toInt(0, 16));
-					} else if ((line[4] == 'h') || (line[5] == 'h')) {
-						sym = new Symbol(l.at(1).trimmed(), l.at(0).mid(l.at(0).indexOf('h') - 4, 4).toInt(0, 16));
-					} else {
-						QString m = l.at(0);
-						QStringList n = m.split(":"); // n.at(0) = MegaROM page
-						sym = new Symbol(l.at(1).trimmed(), n.at(1).left(4).toInt(0, 16));
-					}
-					sym->setSource(&symbolFiles.back().fileName);
-					add(sym);
-				} else if (filePart == 2) {
-					//
-				}
-			}
-		}
-	}
+	parseLines(data.begin(), data.end(),
+		[&filePart](const char* first, const char* last) {
+			return parseASMSXLine(first, last, filePart);
+		}, list);
 	return true;
 }
 
-bool SymbolTable::readPASMOFile(const QString& filename)
+bool SymbolTable::readPASMOFile(const QString& filename, std::vector<Symbol*>& list)
 {
-	QFile file( filename );
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	SymbolFileData data;
+	if (!data.open(filename)) {
 		return false;
 	}
-	appendFile(filename, PASMO_FILE);
-	QTextStream in(&file);
-	while (!in.atEnd()) {
-		QString line;	
-		QStringList l;
-		Symbol* sym;
-		line = in.readLine();
-		l = line.split(QRegExp("(\t+)|( +)"));
-		if (l.size() == 3) {
-			sym = new Symbol(l.at(0), l.at(2).left(5).toInt(0, 16));
-			sym->setSource(&symbolFiles.back().fileName);
-			add(sym);
-		}
-	}
+	list = parseFile(data, parsePASMOLine);
 	return true;
 }
 
-bool SymbolTable::readHTCFile(const QString& filename)
+bool SymbolTable::readHTCFile(const QString& filename, std::vector<Symbol*>& list)
 {
-	QFile file(filename);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	SymbolFileData data;
+	if (!data.open(filename)) {
 		return false;
 	}
 
-	appendFile(filename, HTC_FILE);
-	QTextStream in(&file);
-	while (!in.atEnd()) {
-		QString line = in.readLine();
-		QStringList l = line.split(' ');
-		if (l.size() != 3) continue;
-		int value;
-		if (!parseValue("0x" + l.at(1), value)) continue;
-		Symbol* sym = new Symbol(l.at(0), value);
-		sym->setSource(&symbolFiles.back().fileName);
-		add(sym);
-	}
+	list = parseFile(data, parseHTCLine);
 	return true;
 }
 
-bool SymbolTable::readLinkMapFile(const QString& filename)
+bool SymbolTable::readLinkMapFile(const QString& filename, std::vector<Symbol*>& list)
 {
-	const QString magic("Machine type");
-	const QString tableStart("*\tSymbol Table");
-
-	QRegExp rx(" [0-9A-Fa-f]{4}  (?![ 0-9])");
-	QRegExp rp("^([^ ]+) +[^ ]* +([0-9A-Fa-f]{4})  $");
+	static const char magic[] = "Machine type";
+	static const char tableStart[] = "*\tSymbol Table";
 
-	QFile file(filename);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+	SymbolFileData data;
+	if (!data.open(filename)) {
 		return false;
 	}
-	appendFile(filename, LINKMAP_FILE);
 
-	QTextStream in(&file);
-	if (in.atEnd()) return false;
-	if (!in.readLine().startsWith(magic)) return false;
+	// the symbols follow the table header
+	const char* pos = data.begin();
+	const char* end = data.end();
+	bool firstLine = true;
 	while (true) {
-		if (in.atEnd()) return false;
-		if (in.readLine().startsWith(tableStart)) break;
-	}
-
-	while (!in.atEnd()) {
-		QString line = in.readLine();
-		Q_ASSERT(!line.endsWith("\r"));
-		if (line.isEmpty()) continue;
-
-		line += "  ";
-		int len = line.length();
-		int l;
-		int pos = 0;
-		bool ok = false;
-		// HiTech uses multiple columns of non-fixed width and
-		// a column for psect may be blank so the address may in
-		// the first or second match.
-		for (int tries = 0; (tries < 2) && !ok; ++tries) {
-			pos = rx.indexIn(line, pos);
-			l = pos + rx.matchedLength();
-			if ((l > 0) && (len % l) == 0) {
-				ok = true;
-				for (int posn = pos + l; (posn < len) && ok; posn += l) {
-					ok = (posn == rx.indexIn(line, posn));
-				}
-			}
-			pos = l - 1;
-		}
-		if (!ok) continue;
-
-		for (pos = 0; pos < len; pos += l) {
-			QString part = line.mid(pos, l);
-			if (rp.indexIn(part) == 0) {
-				QStringList l = rp.capturedTexts();
-				Symbol* sym = new Symbol(l.at(1), l.last().toInt(0, 16));
-				sym->setSource(&symbolFiles.back().fileName);
-				add(sym);
-			}
+		if (pos == end) return false;
+		const char* eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if (!eol) eol = end;
+		bool found = startsWith(pos, eol, firstLine ? magic : tableStart);
+		pos = (eol == end) ? end : eol + 1;
+		if (firstLine) {
+			if (!found) return false;
+			firstLine = false;
+		} else if (found) {
+			break;
 		}
 	}
+
+	// a line holds several symbols, so they're added to the list here
+	parseLines(pos, end,
+		[&list](const char* first, const char* last) {
+			parseLinkMapLine(first, last, list);
+			return static_cast<Symbol*>(0);
+		}, list);
 	return true;
 }
 
@@ -464,58 +950,82 @@ void SymbolTable::fileChanged(const QString & /*path*/)
 
 void SymbolTable::reloadFiles()
 {
+	QList<int> addresses;
+	QList<Symbol*> added;
+	QList<Symbol*> changed;
+
 	for (int i = 0; i < symbolFiles.size(); ++i) {
+		SymbolFileRecord& record = symbolFiles[i];
 		// check if file is newer
-		QFileInfo fi = QFileInfo(symbolFiles[i].fileName);
-		if (fi.lastModified() <= symbolFiles[i].refreshTime) continue;
-
-		// file info
-		QString name = symbolFiles[i].fileName;
-		FileType type = symbolFiles[i].fileType;
-		// symbol file is newer
-		QMap<QString, Symbol> symCopy;
-		// copy all symbols originating from this file
-		QMutableListIterator<Symbol*> si(symbols);
-		while (si.hasNext()) {
-			si.next();
-			if (si.value()->source() == &symbolFiles[i].fileName) {
-				symCopy.insert(si.value()->text(), Symbol(*si.value()));
+		QFileInfo fi = QFileInfo(record.fileName);
+		if (fi.lastModified() <= record.refreshTime) continue;
+
+		// keep the old symbols if the new file can't be read, it may be
+		// halfway through being written
+		std::vector<Symbol*> list;
+		if (!readSymbols(record.fileName, record.fileType, list)) {
+			qDeleteAll(list.begin(), list.end());
+			continue;
+		}
+		record.refreshTime = QDateTime::currentDateTime();
+
+		// symbols that came from this file before, by name
+		QHash<QString, Symbol*> previous;
+		for (QList<Symbol*>::iterator it = symbols.begin();
+		     it != symbols.end(); ++it) {
+			if ((*it)->source() == &record.fileName) {
+				previous.insert((*it)->text(), *it);
 			}
 		}
-		// remove existing file
-		unloadFile(name);
-		// read the new file
-		readFile(name, type);
-		// find old symbols in newly loaded file
-		QMutableListIterator<Symbol*> ni(symbols);
-		QString* newFile = &symbolFiles.back().fileName;
-		while (ni.hasNext()) {
-			ni.next();
-			if (ni.value()->source() != newFile) continue;
-
-			// find symbol in old list
-			QMap<QString, Symbol>::iterator sit = symCopy.find(ni.value()->text());
-			if (sit == symCopy.end()) continue;
-
-			// symbol existed before, copy settings
-			ni.value()->setValidSlots(sit->validSlots());
-			ni.value()->setValidRegisters(sit->validRegisters());
-			ni.value()->setType(sit->type());
-			if (sit->status() == Symbol::LOST) {
-				ni.value()->setStatus(Symbol::ACTIVE);
-			} else {
-				ni.value()->setStatus(sit->status());
+
+		std::vector<Symbol*> newSymbols;
+		bool moved = false;
+		for (unsigned j = 0; j < list.size(); ++j) {
+			Symbol* sym = list[j];
+			QHash<QString, Symbol*>::iterator it = previous.find(sym->text());
+			if (it == previous.end()) {
+				sym->setSource(&record.fileName);
+				newSymbols.push_back(sym);
+				added.append(sym);
+				addresses.append(sym->value());
+				continue;
+			}
+			// the existing symbol keeps the user's settings, only its
+			// value follows the file
+			Symbol* old = it.value();
+			previous.erase(it);
+			bool update = false;
+			if (old->value() != sym->value()) {
+				addresses << old->value() << sym->value();
+				// the index is rebuilt once, after the whole file
+				old->symValue = sym->value();
+				moved = true;
+				update = true;
+			}
+			if (old->status() == Symbol::LOST) {
+				old->setStatus(Symbol::ACTIVE);
+				addresses.append(old->value());
+				update = true;
 			}
-			symCopy.erase(sit);
+			if (update) changed.append(old);
+			delete sym;
 		}
-		// all symbols left in map are lost
-		for (QMap<QString, Symbol>::iterator sit = symCopy.begin();
-		     sit != symCopy.end(); ++sit) {
-			Symbol* sym = new Symbol(sit.value());
-			sym->setStatus(Symbol::LOST);
-			sym->setSource(newFile);
-			add(sym);
+		// the rest has disappeared from the file, these aren't deleted
+		// so custom settings survive a bad assembler run
+		for (QHash<QString, Symbol*>::iterator it = previous.begin();
+		     it != previous.end(); ++it) {
+			if (it.value()->status() == Symbol::LOST) continue;
+			it.value()->setStatus(Symbol::LOST);
+			changed.append(it.value());
+			addresses.append(it.value()->value());
 		}
+
+		if (moved) rebuildIndex();
+		addSymbols(newSymbols);
+	}
+
+	if (!addresses.isEmpty()) {
+		emit symbolsReloaded(addresses, added, changed);
 	}
 }
 
@@ -532,18 +1042,29 @@ void SymbolTable::unloadFile(const QString& file, bool keepSymbols)
 		QString* name = &symbolFiles[index].fileName;
 
 		if (!keepSymbols) {
-			// remove symbols from address map
-			QMutableMapIterator<int, Symbol*> mi(addressSymbols);
-			while (mi.hasNext()) {
-				mi.next();
-				if (mi.value()->source() == name) mi.remove();
-			}
-			// remove symbols from value hash
+			// remove symbols from address index in a single pass
+			addressIndex.erase(std::remove_if(
+				addressIndex.begin(), addressIndex.end(),
+				[name](const IndexEntry& e) { return e.symbol->source() == name; }),
+				addressIndex.end());
+			// remove symbols from value and name hashes
 			QMutableHashIterator<int, Symbol*> hi(valueSymbols);
 			while (hi.hasNext()) {
 				hi.next();
 				if (hi.value()->source() == name) hi.remove();
 			}
+			QMutableHashIterator<QString, Symbol*> ni(nameSymbols);
+			while (ni.hasNext()) {
+				ni.next();
+				if (ni.value()->source() == name) ni.remove();
+			}
+			QMutableHashIterator<QString, Symbol*> fi(foldedNameSymbols);
+			while (fi.hasNext()) {
+				fi.next();
+				if (fi.value()->source() == name) fi.remove();
+			}
+			completionIndexValid = false;
+			visibleValid = false;
 		}
 		// remove symbols from value hash
 		QMutableListIterator<Symbol*> i(symbols);
@@ -555,6 +1076,7 @@ void SymbolTable::unloadFile(const QString& file, bool keepSymbols)
 					sym->setSource(0);
 				} else {
 					i.remove();
+					indexKeys.remove(sym);
 					delete sym;
 				}
 			}
@@ -633,6 +1155,8 @@ void SymbolTable::saveSymbols(QXmlStreamWriter& xml)
 
 void SymbolTable::loadSymbols(QXmlStreamReader& xml)
 {
+	// symbols are completed before they're added to the index
+	std::vector<Symbol*> list;
 	Symbol* sym;
 	while (!xml.atEnd()) {
 		xml.readNext();
@@ -664,7 +1188,7 @@ void SymbolTable::loadSymbols(QXmlStreamReader& xml)
 			} else if (xml.name() == "Symbol") {
 				// add empty symbol
 				sym = new Symbol("", 0);
-				add(sym);
+				list.push_back(sym);
 				// get status attribute
 				QString stat = xml.attributes().value("status").toString().toLower();
 				if (stat == "hidden") {
@@ -709,6 +1233,208 @@ void SymbolTable::loadSymbols(QXmlStreamReader& xml)
 			}
 		}
 	}
+	addSymbols(list);
+}
+
+/*
+ * Binary cache
+ */
+static const quint32 CACHE_MAGIC = 0x4F4D5343; // "OMSC"
+static const quint32 CACHE_VERSION = 2;
+
+QString SymbolTable::cacheFileName(const QString& sourceFile)
+{
+	QByteArray key = QCryptographicHash::hash(
+		QFileInfo(sourceFile).absoluteFilePath().toUtf8(),
+		QCryptographicHash::Md5).toHex();
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+	       + "/symbols/" + QString::fromLatin1(key) + ".bin";
+}
+
+bool SymbolTable::saveCache(const QString& cacheFile, const QString& sourceFile,
+                            qint64 symbolsStart, qint64 symbolsEnd) const
+{
+	QFileInfo source(sourceFile);
+	if (!source.exists()) return false;
+	QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+	// written to a temporary file that replaces the cache only when it's
+	// complete, so an interrupted save or a second debugger never leaves
+	// a truncated cache behind
+	QSaveFile file(cacheFile);
+	if (!file.open(QIODevice::WriteOnly)) return false;
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_0);
+	// the source file this is a copy of
+	out << CACHE_MAGIC << CACHE_VERSION
+	    << source.absoluteFilePath().toUtf8()
+	    << qint64(source.size())
+	    << qint64(source.lastModified().toMSecsSinceEpoch())
+	    << symbolsStart << symbolsEnd;
+
+	QHash<const QString*, qint32> fileIds;
+	out << quint32(symbolFiles.size());
+	for (int i = 0; i < symbolFiles.size(); ++i) {
+		fileIds.insert(&symbolFiles[i].fileName, i);
+		out << symbolFiles[i].fileName.toUtf8()
+		    << qint32(symbolFiles[i].fileType)
+		    << qint64(symbolFiles[i].refreshTime.toMSecsSinceEpoch());
+	}
+
+	out << quint32(symbols.size());
+	for (QList<Symbol*>::const_iterator it = symbols.begin();
+	     it != symbols.end(); ++it) {
+		const Symbol* sym = *it;
+		out << sym->symText.toUtf8()
+		    << qint32(sym->symValue)
+		    << qint32(sym->symSlots)
+		    << qint32(sym->symRegisters)
+		    << qint32(sym->symSource ? fileIds.value(sym->symSource, -1) : -1)
+		    << quint8(sym->symStatus)
+		    << quint8(sym->symType)
+		    << quint8(sym->symSegments.size());
+		for (int i = 0; i < sym->symSegments.size(); ++i) {
+			out << quint8(sym->symSegments[i]);
+		}
+	}
+	if (out.status() != QDataStream::Ok) {
+		file.cancelWriting();
+	}
+	return file.commit();
+}
+
+bool SymbolTable::loadCache(const QString& cacheFile, const QString& sourceFile,
+                            qint64& symbolsStart, qint64& symbolsEnd)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly) || file.size() == 0) return false;
+	// read straight from the mapped file, without copying it first
+	const uchar* data = file.map(0, file.size());
+	QByteArray bytes;
+	if (data) {
+		bytes = QByteArray::fromRawData(
+			reinterpret_cast<const char*>(data), int(file.size()));
+	} else {
+		bytes = file.readAll();
+	}
+	QDataStream in(bytes);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	// only a copy of this exact source file is any good
+	quint32 magic, version;
+	QByteArray path;
+	qint64 size, modified, start, end;
+	in >> magic >> version >> path >> size >> modified >> start >> end;
+	QFileInfo source(sourceFile);
+	if (in.status() != QDataStream::Ok ||
+	    magic != CACHE_MAGIC || version != CACHE_VERSION ||
+	    QString::fromUtf8(path) != source.absoluteFilePath() ||
+	    size != source.size() ||
+	    modified != source.lastModified().toMSecsSinceEpoch()) {
+		return false;
+	}
+
+	// read everything before the table is touched
+	quint32 fileCount;
+	in >> fileCount;
+	QList<SymbolFileRecord> files;
+	for (quint32 i = 0; i < fileCount && in.status() == QDataStream::Ok; ++i) {
+		QByteArray name;
+		qint32 type;
+		qint64 refresh;
+		in >> name >> type >> refresh;
+		SymbolFileRecord rec;
+		rec.fileName = QString::fromUtf8(name);
+		rec.fileType = FileType(type);
+		rec.refreshTime = QDateTime::fromMSecsSinceEpoch(refresh);
+		files.append(rec);
+	}
+
+	quint32 symbolCount;
+	in >> symbolCount;
+	std::vector<Symbol*> list;
+	std::vector<qint32> sources;
+	list.reserve(symbolCount);
+	sources.reserve(symbolCount);
+	for (quint32 i = 0; i < symbolCount && in.status() == QDataStream::Ok; ++i) {
+		QByteArray text;
+		qint32 value, validSlots, registers, source;
+		quint8 status, type, segments;
+		in >> text >> value >> validSlots >> registers >> source
+		   >> status >> type >> segments;
+		Symbol* sym = new Symbol(QString::fromUtf8(text), value, validSlots);
+		sym->symRegisters = registers;
+		sym->symStatus = Symbol::SymbolStatus(status);
+		sym->symType = Symbol::SymbolType(type);
+		for (int j = 0; j < segments; ++j) {
+			quint8 segment;
+			in >> segment;
+			sym->symSegments.append(segment);
+		}
+		list.push_back(sym);
+		sources.push_back(source);
+	}
+	if (in.status() != QDataStream::Ok) {
+		qDeleteAll(list.begin(), list.end());
+		return false;
+	}
+
+	int firstFile = symbolFiles.size();
+	for (int i = 0; i < files.size(); ++i) {
+		appendFile(files[i].fileName, files[i].fileType);
+		symbolFiles.back().refreshTime = files[i].refreshTime;
+	}
+	for (unsigned i = 0; i < list.size(); ++i) {
+		if (sources[i] >= 0 && sources[i] < files.size()) {
+			list[i]->symSource = &symbolFiles[firstFile + sources[i]].fileName;
+		}
+	}
+	addSymbols(list);
+	symbolsStart = start;
+	symbolsEnd = end;
+	return true;
+}
+
+
+// class SymbolTable::AddressIterator
+
+SymbolTable::AddressIterator::AddressIterator()
+	: pos(0), end(0), memLayout(0)
+{
+}
+
+SymbolTable::AddressIterator::AddressIterator(
+		const IndexEntry* first, const IndexEntry* last, const MemoryLayout* ml)
+	: pos(first), end(last), memLayout(ml)
+{
+	skipInvalid();
+}
+
+void SymbolTable::AddressIterator::skipInvalid()
+{
+	while (pos != end && !pos->symbol->isSlotValid(memLayout)) ++pos;
+}
+
+Symbol* SymbolTable::AddressIterator::operator*() const
+{
+	return pos->symbol;
+}
+
+Symbol* SymbolTable::AddressIterator::operator->() const
+{
+	return pos->symbol;
+}
+
+SymbolTable::AddressIterator& SymbolTable::AddressIterator::operator++()
+{
+	++pos;
+	skipInvalid();
+	return *this;
+}
+
+bool SymbolTable::AddressIterator::atEnd() const
+{
+	return pos == end;
 }
 
 
@@ -748,7 +1474,10 @@ const QString& Symbol::text() const
 
 void Symbol::setText(const QString& str)
 {
+	if (str == symText) return;
+
 	symText = str;
+	if (table) table->symbolTextChanged(this);
 }
 
 int Symbol::value() const
@@ -772,6 +1501,7 @@ int Symbol::validSlots() const
 void Symbol::setValidSlots(int val)
 {
 	symSlots = val & 0xFFFF;
+	if (table) table->symbolSlotsChanged(this);
 }
 
 int Symbol::validRegisters() const
@@ -838,3 +1568,12 @@ bool Symbol::isSlotValid(const MemoryLayout* ml) const
 	return false;
 }
 
+bool Symbol::isSegmentValid(int segment) const
+{
+	if (symSegments.empty()) return true;
+	for (int i = 0; i < symSegments.size(); ++i) {
+		if (symSegments[i] == segment) return true;
+	}
+	return false;
+}
+
@@ -3,12 +3,12 @@
 
 #include <QString>
 #include <QList>
-#include <QMultiMap>
 #include <QMultiHash>
 #include <QDateTime>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QFileSystemWatcher>
+#include <vector>
 
 struct MemoryLayout;
 class SymbolTable;
@@ -52,6 +52,8 @@ public:
 	void setType(SymbolType t);
 
 	bool isSlotValid(const MemoryLayout* ml = 0) const;
+	// true if the symbol is in segment, or isn't tied to segments
+	bool isSegmentValid(int segment) const;
 
 private:
 	SymbolTable* table;
@@ -72,6 +74,11 @@ private:
 class SymbolTable : public QObject
 {
 	Q_OBJECT
+	struct IndexEntry {
+		int value;
+		Symbol* symbol;
+	};
+
 public:
 	enum FileType {
 		DETECT_FILE,
@@ -88,6 +95,7 @@ public:
 	~SymbolTable();
 
 	void add(Symbol* symbol);
+	void addSymbols(const std::vector<Symbol*>& list);
 	void removeAt(int index);
 	void remove(Symbol *symbol);
 	void clear();
@@ -97,18 +105,70 @@ public:
 	void saveSymbols(QXmlStreamWriter& xml);
 	void loadSymbols(QXmlStreamReader& xml);
 
+	/* Binary copy of the whole table, which loads a lot faster than the
+	 * xml. A cache is only accepted for the exact source file (path, size
+	 * and modification time) it was saved for. It also keeps the byte
+	 * range of the symbols in the source file, so a reader of that file
+	 * can leave them out when they come from the cache.
+	 */
+	static QString cacheFileName(const QString& sourceFile);
+	bool saveCache(const QString& cacheFile, const QString& sourceFile,
+	               qint64 symbolsStart, qint64 symbolsEnd) const;
+	bool loadCache(const QString& cacheFile, const QString& sourceFile,
+	               qint64& symbolsStart, qint64& symbolsEnd);
+
+	/* Walks the address labels in order of their value, skipping the
+	 * ones that aren't visible in the given memory layout. The position
+	 * is kept in the iterator, so independent walks don't interfere.
+	 * Changing the table invalidates the iterator.
+	 */
+	class AddressIterator
+	{
+	public:
+		// an iterator that is at the end
+		AddressIterator();
+
+		Symbol* operator*() const;
+		Symbol* operator->() const;
+		AddressIterator& operator++();
+		bool atEnd() const;
+
+	private:
+		AddressIterator(const IndexEntry* first, const IndexEntry* last,
+		                const MemoryLayout* ml);
+		void skipInvalid();
+
+		const IndexEntry* pos;
+		const IndexEntry* end;
+		const MemoryLayout* memLayout;
+
+		friend class SymbolTable;
+	};
+
 	/* Symbol access functions */
-	Symbol* findFirstAddressSymbol(int addr, MemoryLayout* ml = 0);
-	Symbol* getCurrentAddressSymbol();
-	Symbol* findNextAddressSymbol(MemoryLayout* ml = 0);
+	AddressIterator addressSymbols(int addr = 0, const MemoryLayout* ml = 0) const;
 	Symbol* getValueSymbol(int val, Symbol::Register reg, MemoryLayout* ml = 0);
 	Symbol* getAddressSymbol(int val, MemoryLayout* ml = 0);
 	Symbol* getAddressSymbol(const QString& label, bool case_sensitive = false);
 
-	QStringList labelList(bool include_vars = false, const MemoryLayout* ml = 0) const;
+	/* Label names to complete text with, best matches first: names that
+	 * start with text, then names that contain it and finally names that
+	 * contain its characters in the same order. Case is ignored.
+	 */
+	QStringList labelCompletions(const QString& text, int maxCount,
+		bool include_vars = false, const MemoryLayout* ml = 0) const;
 
 	void symbolTypeChanged(Symbol* symbol);
 	void symbolValueChanged(Symbol* symbol);
+	void symbolTextChanged(Symbol* symbol);
+	void symbolSlotsChanged(Symbol* symbol);
+
+	/* Lookups in this layout use a precomputed list of the symbols that
+	 * are visible in it. layoutChanged() has to be called whenever the
+	 * mapped slots or segments change.
+	 */
+	void setMemoryLayout(const MemoryLayout* ml);
+	void layoutChanged();
 
 	int symbolFilesSize() const;
 	const QString& symbolFile(int index) const;
@@ -120,23 +180,61 @@ public:
 
 private:
 	void appendFile(const QString& file, FileType type);
-	bool readSymbolFile(
-		const QString& filename, FileType type, const QString& equ);
-	bool readTNIASM0File(const QString& filename);
-	bool readTNIASM1File(const QString& filename);
-	bool readASMSXFile(const QString& filename);
-	bool readSJASMFile(const QString& filename);
-	bool readHTCFile(const QString& filename);
-	bool readLinkMapFile(const QString& filename);
-	bool readPASMOFile(const QString& filename);
-
-	void mapSymbol(Symbol* symbol);
+	bool readSymbols(const QString& filename, FileType type,
+	                 std::vector<Symbol*>& list);
+	bool readSymbolFile(const QString& filename, const QString& equ,
+	                    std::vector<Symbol*>& list);
+	bool readTNIASM0File(const QString& filename, std::vector<Symbol*>& list);
+	bool readTNIASM1File(const QString& filename, std::vector<Symbol*>& list);
+	bool readASMSXFile(const QString& filename, std::vector<Symbol*>& list);
+	bool readSJASMFile(const QString& filename, std::vector<Symbol*>& list);
+	bool readHTCFile(const QString& filename, std::vector<Symbol*>& list);
+	bool readLinkMapFile(const QString& filename, std::vector<Symbol*>& list);
+	bool readPASMOFile(const QString& filename, std::vector<Symbol*>& list);
+
+	void addFileSymbols(std::vector<Symbol*>& list);
+	void mapSymbol(Symbol* symbol, bool keepSorted = true);
+	void rebuildIndex();
+	bool useVisibleSymbols(const MemoryLayout* ml) const;
 	void unmapSymbol(Symbol* symbol);
+	void mapName(Symbol* symbol);
+	void unmapName(const QString& name, Symbol* symbol);
+	std::vector<IndexEntry>::const_iterator firstAddressEntry(int addr) const;
+	void updateCompletionIndex() const;
 
 	QList<Symbol*> symbols;
-	QMultiMap<int, Symbol*> addressSymbols;
+	/* Address labels, sorted on value. Lookups are a binary search, but a
+	 * single insert or remove moves the tail of the vector, which is linear.
+	 * That memmove of small entries is cheap next to the pointer chasing
+	 * of a tree on every lookup, and files are added and removed in bulk
+	 * (addSymbols() and unloading a file) in one pass anyway.
+	 */
+	std::vector<IndexEntry> addressIndex;
 	QMultiHash<int, Symbol*> valueSymbols;
-	QMultiMap<int, Symbol*>::iterator currentAddress;
+	// address labels by name, exact and case folded
+	QMultiHash<QString, Symbol*> nameSymbols;
+	QMultiHash<QString, Symbol*> foldedNameSymbols;
+	// value, type and name every symbol was indexed with, so it can be
+	// found again after any of them changed
+	struct IndexKey {
+		int value;
+		Symbol::SymbolType type;
+		QString text;
+	};
+	QHash<const Symbol*, IndexKey> indexKeys;
+	// address labels sorted on case folded name, rebuilt when needed
+	struct CompletionEntry {
+		QString folded;
+		Symbol* symbol;
+	};
+	mutable std::vector<CompletionEntry> completionIndex;
+	mutable bool completionIndexValid;
+	// address and value symbols visible in the current layout, rebuilt
+	// when needed
+	const MemoryLayout* visibleLayout;
+	mutable std::vector<IndexEntry> visibleIndex;
+	mutable QMultiHash<int, Symbol*> visibleValueSymbols;
+	mutable bool visibleValid;
 
 	struct SymbolFileRecord {
 		QString fileName;
@@ -151,6 +249,13 @@ private slots:
 
 signals:
 	void symbolFileChanged();
+	/* Emitted by reloadFiles(). Lists the labels that appeared in the
+	 * files and the ones that moved, disappeared or came back, together
+	 * with every address whose labels differ from before the reload.
+	 */
+	void symbolsReloaded(const QList<int>& addresses,
+	                     const QList<Symbol*>& added,
+	                     const QList<Symbol*>& changed);
 };
 
 #endif // SYMBOLTABLE_H
@@ -0,0 +1,111 @@
+#include "TileViewer.h"
+#include "VramTiledView.h"
+#include "VDPDataStore.h"
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QScrollArea>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+TileViewer::TileViewer(QWidget* parent)
+	: QDialog(parent)
+{
+	showCombo = new QComboBox();
+	showCombo->addItem(tr("Patterns"));
+	showCombo->addItem(tr("Name table"));
+	showCombo->addItem(tr("Sprites"));
+	showCombo->setCurrentIndex(1);
+	zoomSpin = new QSpinBox();
+	zoomSpin->setRange(1, 8);
+	zoomSpin->setValue(2);
+	zoomSpin->setPrefix(tr("Zoom "));
+	modeLabel = new QLabel();
+	refreshButton = new QPushButton(tr("Refresh"));
+	infoLabel = new QLabel();
+
+	view = new VramTiledView();
+	QScrollArea* scrollArea = new QScrollArea();
+	scrollArea->setWidget(view);
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->addWidget(showCombo);
+	hbox->addWidget(zoomSpin);
+	hbox->addWidget(modeLabel);
+	hbox->addStretch();
+	hbox->addWidget(refreshButton);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->addLayout(hbox);
+	vbox->addWidget(scrollArea);
+	vbox->addWidget(infoLabel);
+	setLayout(vbox);
+
+	VDPDataStore& store = VDPDataStore::instance();
+
+	// the view redraws only the cells whose glyphs changed
+	connect(&store, SIGNAL(regsChanged()), this, SLOT(regsChanged()));
+	connect(&store, SIGNAL(paletteChanged()), this, SLOT(paletteChanged()));
+	connect(&store, SIGNAL(vramChanged(const QList<VramRange>&)),
+	        view, SLOT(vramChanged(const QList<VramRange>&)));
+	connect(refreshButton, SIGNAL(clicked()), this, SLOT(refresh()));
+	connect(showCombo, SIGNAL(currentIndexChanged(int)),
+	        this, SLOT(showSelected(int)));
+	connect(zoomSpin, SIGNAL(valueChanged(int)), this, SLOT(zoomChanged(int)));
+	connect(view, SIGNAL(tileInfo(const QString&)),
+	        infoLabel, SLOT(setText(const QString&)));
+
+	regsChanged();
+	store.refresh();
+}
+
+void TileViewer::refresh()
+{
+	VDPDataStore::instance().refresh();
+}
+
+void TileViewer::showSelected(int index)
+{
+	static const VramTiledView::DrawMode modes[3] = {
+		VramTiledView::PATTERNS, VramTiledView::NAMES, VramTiledView::SPRITES
+	};
+	if (index < 0 || index > 2) return;
+	view->setDrawMode(modes[index]);
+	infoLabel->clear();
+}
+
+void TileViewer::zoomChanged(int zoom)
+{
+	view->setZoom(zoom);
+}
+
+void TileViewer::updateSources()
+{
+	// the registers and palette follow the VRAM, so they move when the
+	// VRAM size is known or changes
+	VDPDataStore& store = VDPDataStore::instance();
+	view->setVramSource(store.getVramPointer());
+	view->setRegsSource(store.getRegsPointer());
+	view->setPaletteSource(store.getPalettePointer());
+}
+
+void TileViewer::paletteChanged()
+{
+	updateSources();
+	view->refresh();
+}
+
+void TileViewer::regsChanged()
+{
+	updateSources();
+	view->refresh();
+	int mode = view->screenMode();
+	if (mode == -1) {
+		modeLabel->setText(tr("Not a tile mode"));
+	} else if (mode == 80) {
+		modeLabel->setText(tr("Screen 0, width 80"));
+	} else {
+		modeLabel->setText(tr("Screen %1").arg(mode));
+	}
+}
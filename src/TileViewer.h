@@ -0,0 +1,36 @@
+#ifndef TILEVIEWER_H
+#define TILEVIEWER_H
+
+#include <QDialog>
+
+class VramTiledView;
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QSpinBox;
+
+class TileViewer : public QDialog
+{
+	Q_OBJECT
+public:
+	TileViewer(QWidget* parent = 0);
+
+private slots:
+	void refresh();
+	void showSelected(int index);
+	void zoomChanged(int zoom);
+	void regsChanged();
+	void paletteChanged();
+
+private:
+	void updateSources();
+
+	VramTiledView* view;
+	QComboBox* showCombo;
+	QSpinBox* zoomSpin;
+	QLabel* modeLabel;
+	QLabel* infoLabel;
+	QPushButton* refreshButton;
+};
+
+#endif // TILEVIEWER_H
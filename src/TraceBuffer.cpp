@@ -0,0 +1,72 @@
+#include "TraceBuffer.h"
+
+TraceBuffer::TraceBuffer(int capacity)
+{
+	setCapacity(capacity);
+}
+
+void TraceBuffer::clear()
+{
+	head = 0;
+	count = 0;
+	total = 0;
+}
+
+void TraceBuffer::setCapacity(int capacity)
+{
+	pcs.assign(capacity, 0);
+	opcodes.assign(capacity, 0);
+	for (int r = 0; r < NUM_REGS; ++r) {
+		regs[r].assign(capacity, 0);
+	}
+	clear();
+}
+
+int TraceBuffer::capacity() const
+{
+	return int(pcs.size());
+}
+
+int TraceBuffer::size() const
+{
+	return count;
+}
+
+quint64 TraceBuffer::totalCount() const
+{
+	return total;
+}
+
+void TraceBuffer::append(quint16 pc, quint32 opcode, const quint16* r)
+{
+	if (pcs.empty()) return;
+	pcs[head] = pc;
+	opcodes[head] = opcode;
+	for (int i = 0; i < NUM_REGS; ++i) {
+		regs[i][head] = r[i];
+	}
+	if (++head == capacity()) head = 0;
+	if (count < capacity()) ++count;
+	++total;
+}
+
+int TraceBuffer::position(int index) const
+{
+	int p = head - count + index;
+	return p < 0 ? p + capacity() : p;
+}
+
+quint16 TraceBuffer::pc(int index) const
+{
+	return pcs[position(index)];
+}
+
+quint32 TraceBuffer::opcode(int index) const
+{
+	return opcodes[position(index)];
+}
+
+quint16 TraceBuffer::reg(int index, Register r) const
+{
+	return regs[r][position(index)];
+}
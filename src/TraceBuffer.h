@@ -0,0 +1,46 @@
+#ifndef TRACEBUFFER_H
+#define TRACEBUFFER_H
+
+#include <QtGlobal>
+#include <vector>
+
+/** Ring buffer with the recorded instruction trace.
+  * Every field is kept in its own array (struct of arrays), so a trace of
+  * millions of instructions stays compact and appending never allocates.
+  * When the buffer is full the oldest entries are overwritten.
+  */
+class TraceBuffer
+{
+public:
+	enum Register { AF, BC, DE, HL, IX, IY, SP, NUM_REGS };
+
+	// without a capacity nothing is allocated and nothing is recorded
+	TraceBuffer(int capacity = 0);
+
+	void clear();
+	void setCapacity(int capacity);
+	int capacity() const;
+	int size() const;
+	// total number of entries ever appended, including overwritten ones
+	quint64 totalCount() const;
+
+	void append(quint16 pc, quint32 opcode, const quint16* regs);
+
+	// index 0 is the oldest entry still in the buffer
+	quint16 pc(int index) const;
+	// the 4 bytes at pc, first byte in the lowest bits
+	quint32 opcode(int index) const;
+	quint16 reg(int index, Register r) const;
+
+private:
+	int position(int index) const;
+
+	std::vector<quint16> pcs;
+	std::vector<quint32> opcodes;
+	std::vector<quint16> regs[NUM_REGS];
+	int head;
+	int count;
+	quint64 total;
+};
+
+#endif // TRACEBUFFER_H
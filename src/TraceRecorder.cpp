@@ -0,0 +1,162 @@
+#include "TraceRecorder.h"
+#include "TraceBuffer.h"
+#include "CommClient.h"
+#include "OpenMSXConnection.h"
+#include "Convert.h"
+#include <algorithm>
+
+// length of a single entry in the fetched data:
+// AF BC DE HL IX IY PC SP and 4 opcode bytes, all in hex
+static const int ENTRY_LENGTH = 40;
+// most entries kept in the buffer, the oldest ones are overwritten
+static const int MAX_ENTRIES = 1 << 20;
+
+static quint16 hex16(const char* p)
+{
+	return (hexDigitValue(p[0]) << 12) | (hexDigitValue(p[1]) << 8) |
+	       (hexDigitValue(p[2]) <<  4) |  hexDigitValue(p[3]);
+}
+
+
+TraceRecorder::TraceRecorder(TraceBuffer& buffer_, QObject* parent)
+	: QObject(parent)
+	, buffer(buffer_)
+	, fetcher("debug_trace_fetch",
+	          [this](const QString& data) { addEntries(data); })
+{
+	running = false;
+
+	fetchTimer.setInterval(250);
+	connect(&fetchTimer, SIGNAL(timeout()), this, SLOT(fetch()));
+	connect(&CommClient::instance(), SIGNAL(connectionTerminated()),
+	        this, SLOT(connectionClosed()));
+}
+
+bool TraceRecorder::isRunning() const
+{
+	return running;
+}
+
+void TraceRecorder::start(int instructions, bool breakWhenDone)
+{
+	if (running) return;
+
+	// the buffer only grows when a trace needs it; growing drops the
+	// previous trace
+	int entries = std::min(instructions, MAX_ENTRIES);
+	if (buffer.capacity() < entries) {
+		buffer.setCapacity(entries);
+		emit traceChanged();
+	}
+
+	// the hook returns true only after the last instruction, the condition
+	// then breaks if requested
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_hook_trace { } {\n"
+		"  if { $::debug_trace_left == 0 } { return 0 }\n"
+		"  binary scan [debug read_block {CPU regs} 0 24] H16x8H16 r1 r2\n"
+		"  set pc [reg PC]\n"
+		"  if { $pc &lt; 0xFFFD } {\n"
+		"    binary scan [debug read_block memory $pc 4] H8 op\n"
+		"  } else {\n"
+		"    set op \"\"\n"
+		"    for { set i 0 } { $i &lt; 4 } { incr i } {\n"
+		"      append op [format %02x [debug read memory [expr {($pc + $i) &amp; 0xFFFF}]]]\n"
+		"    }\n"
+		"  }\n"
+		"  append ::debug_trace_buf $r1 $r2 $op\n"
+		"  if { [incr ::debug_trace_left -1] == 0 } { return $::debug_trace_break }\n"
+		"  return 0\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_trace_fetch { } {\n"
+		"  set result [format %08X $::debug_trace_left]\n"
+		"  append result $::debug_trace_buf\n"
+		"  set ::debug_trace_buf \"\"\n"
+		"  return $result\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		QString("set ::debug_trace_buf \"\"\n"
+		        "set ::debug_trace_left %1\n"
+		        "set ::debug_trace_break %2\n"
+		        "set ::debug_trace_id [debug set_condition {[debug_hook_trace]}]")
+		       .arg(instructions).arg(breakWhenDone ? 1 : 0)));
+
+	running = true;
+	fetchTimer.start();
+	emit runningChanged(true);
+}
+
+void TraceRecorder::stop()
+{
+	if (!running) return;
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"set ::debug_trace_left 0"));
+	// collect the remaining entries, even when a periodic fetch is
+	// still underway; that reply removes the hook
+	fetcher.fetchNow();
+}
+
+void TraceRecorder::finish()
+{
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"debug remove_condition $::debug_trace_id"));
+	running = false;
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void TraceRecorder::clear()
+{
+	buffer.clear();
+	emit traceChanged();
+}
+
+void TraceRecorder::fetch()
+{
+	if (!running) return;
+	fetcher.fetch();
+}
+
+void TraceRecorder::connectionClosed()
+{
+	if (!running) return;
+	running = false;
+	fetchTimer.stop();
+	emit runningChanged(false);
+}
+
+void TraceRecorder::addEntries(const QString& data)
+{
+	if (data.size() < 8) return;
+
+	QByteArray bytes = data.toLatin1();
+	const char* p = bytes.constData();
+	bool done = (hex16(p) | hex16(p + 4)) == 0;
+	p += 8;
+
+	int count = (data.size() - 8) / ENTRY_LENGTH;
+	quint16 regs[TraceBuffer::NUM_REGS];
+	for (int i = 0; i < count; ++i, p += ENTRY_LENGTH) {
+		regs[TraceBuffer::AF] = hex16(p +  0);
+		regs[TraceBuffer::BC] = hex16(p +  4);
+		regs[TraceBuffer::DE] = hex16(p +  8);
+		regs[TraceBuffer::HL] = hex16(p + 12);
+		regs[TraceBuffer::IX] = hex16(p + 16);
+		regs[TraceBuffer::IY] = hex16(p + 20);
+		quint16 pc            = hex16(p + 24);
+		regs[TraceBuffer::SP] = hex16(p + 28);
+		quint32 opcode = 0;
+		for (int j = 3; j >= 0; --j) {
+			opcode = (opcode << 8) |
+			         (hexDigitValue(p[32 + 2 * j]) << 4) | hexDigitValue(p[33 + 2 * j]);
+		}
+		buffer.append(pc, opcode, regs);
+	}
+	if (count) emit traceChanged();
+
+	if (done && running) finish();
+}
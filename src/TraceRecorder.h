@@ -0,0 +1,47 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include "OpenMSXConnection.h"
+#include <QObject>
+#include <QTimer>
+
+class TraceBuffer;
+
+/** Records an instruction trace in openMSX.
+  * A hook condition appends PC, opcode bytes and registers of every
+  * executed instruction to a buffer in openMSX until the requested number
+  * of instructions is reached. The debugger fetches the buffer in bulk,
+  * instead of stepping with a full update per instruction.
+  */
+class TraceRecorder : public QObject
+{
+	Q_OBJECT
+public:
+	TraceRecorder(TraceBuffer& buffer, QObject* parent = 0);
+
+	bool isRunning() const;
+
+public slots:
+	void start(int instructions, bool breakWhenDone);
+	void stop();
+	void clear();
+	void fetch();
+
+signals:
+	void traceChanged();
+	void runningChanged(bool running);
+
+private slots:
+	void connectionClosed();
+
+private:
+	void addEntries(const QString& data);
+	void finish();
+
+	TraceBuffer& buffer;
+	bool running;
+	SingleFetch fetcher;
+	QTimer fetchTimer;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,379 @@
+#include "TraceViewer.h"
+#include "TraceBuffer.h"
+#include "TraceRecorder.h"
+#include "Settings.h"
+#include <QCheckBox>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cstring>
+
+static const char* const regNames[TraceBuffer::NUM_REGS] = {
+	"AF", "BC", "DE", "HL", "IX", "IY", "SP"
+};
+
+
+TraceListView::TraceListView(QWidget* parent)
+	: QFrame(parent)
+{
+	setFrameStyle(WinPanel | Sunken);
+	setFocusPolicy(Qt::StrongFocus);
+	setBackgroundRole(QPalette::Base);
+
+	trace = NULL;
+	symTable = NULL;
+	memLayout = NULL;
+	topLine = 0;
+	cursorLine = 0;
+	visibleLines = 0;
+	memset(dasmMemory, 0, sizeof(dasmMemory));
+
+	scrollBar = new QScrollBar(Qt::Vertical, this);
+	scrollBar->setMinimum(0);
+	scrollBar->setMaximum(0);
+
+	settingsChanged();
+
+	connect(scrollBar, SIGNAL(valueChanged(int)),
+	        this, SLOT(scrollBarChanged(int)));
+}
+
+void TraceListView::setTraceBuffer(const TraceBuffer* buf)
+{
+	trace = buf;
+	traceChanged();
+}
+
+void TraceListView::setSymbolTable(SymbolTable* st)
+{
+	symTable = st;
+}
+
+void TraceListView::setMemoryLayout(MemoryLayout* ml)
+{
+	memLayout = ml;
+}
+
+QSize TraceListView::sizeHint() const
+{
+	return QSize(xRegs + TraceBuffer::NUM_REGS * regWidth + frameR,
+	             20 * lineHeight);
+}
+
+void TraceListView::settingsChanged()
+{
+	frameL = frameT = frameB = frameWidth();
+	frameR = frameL + scrollBar->sizeHint().width();
+
+	QFontMetrics fm(Settings::get().font(Settings::CODE_FONT));
+	lineHeight = fm.height();
+	lineAscent = fm.ascent();
+
+	// calculate layout locations
+	int charWidth = fm.width("0");
+	xIndex = frameL + 4;
+	xAddr = xIndex + 9 * charWidth;
+	xLabel = xAddr + 6 * charWidth;
+	xMCode = xLabel + 13 * charWidth;
+	xMnem = xMCode + 12 * charWidth;
+	xMnemArg = xMnem + 7 * charWidth;
+	xRegs = xMnemArg + 15 * charWidth;
+	regWidth = 8 * charWidth;
+
+	setMinimumHeight(frameT + 5 * lineHeight + frameB);
+	update();
+}
+
+void TraceListView::resizeEvent(QResizeEvent* e)
+{
+	QFrame::resizeEvent(e);
+
+	scrollBar->setGeometry(width() - frameR, frameT,
+	                       scrollBar->sizeHint().width(),
+	                       height() - frameT - frameB);
+	visibleLines = std::max(1, (height() - frameT - frameB) / lineHeight);
+	updateScrollBar();
+}
+
+void TraceListView::updateScrollBar()
+{
+	int size = trace ? trace->size() : 0;
+	scrollBar->setMaximum(std::max(0, size - visibleLines));
+	scrollBar->setPageStep(visibleLines);
+	scrollBar->setSingleStep(1);
+}
+
+void TraceListView::traceChanged()
+{
+	// keep following the end of a running trace
+	bool atEnd = topLine >= scrollBar->maximum();
+	updateScrollBar();
+	int size = trace ? trace->size() : 0;
+	if (cursorLine >= size) cursorLine = std::max(0, size - 1);
+	if (atEnd) {
+		scrollToEnd();
+	} else {
+		setTopLine(topLine);
+	}
+}
+
+void TraceListView::scrollToEnd()
+{
+	setTopLine(scrollBar->maximum());
+}
+
+void TraceListView::scrollBarChanged(int value)
+{
+	if (value != topLine) {
+		topLine = value;
+		update();
+	}
+}
+
+void TraceListView::setTopLine(int line)
+{
+	topLine = std::max(0, std::min(line, scrollBar->maximum()));
+	scrollBar->setValue(topLine);
+	update();
+}
+
+void TraceListView::setCursorLine(int line)
+{
+	int size = trace ? trace->size() : 0;
+	if (size == 0) return;
+	cursorLine = std::max(0, std::min(line, size - 1));
+	if (cursorLine < topLine) {
+		setTopLine(cursorLine);
+	} else if (cursorLine >= topLine + visibleLines) {
+		setTopLine(cursorLine - visibleLines + 1);
+	} else {
+		update();
+	}
+}
+
+void TraceListView::paintEvent(QPaintEvent* e)
+{
+	// call parent for drawing the actual frame
+	QFrame::paintEvent(e);
+
+	QPainter p(this);
+	p.setClipRect(QRect(frameL, frameT, width() - frameL - frameR,
+	                    height() - frameT - frameB));
+
+	Settings& s = Settings::get();
+	p.setFont(s.font(Settings::CODE_FONT));
+
+	if (!trace || !symTable) return;
+
+	QString hexStr;
+	int y = frameT;
+	for (int line = topLine; line < trace->size() && y < height() - frameB;
+	     ++line, y += lineHeight) {
+		quint16 pc = trace->pc(line);
+		quint32 opcode = trace->opcode(line);
+		for (int i = 0; i < 4; ++i) {
+			dasmMemory[pc + i] = (opcode >> (8 * i)) & 0xFF;
+		}
+		dasm(dasmMemory, pc, pc, dasmLines, memLayout, symTable, 0x10000);
+		const DisasmRow* instr = &dasmLines.back();
+		const DisasmRow* label = dasmLines.front().rowType == DisasmRow::LABEL
+		                       ? &dasmLines.front() : NULL;
+
+		if (line == cursorLine) {
+			p.fillRect(frameL, y, width() - frameL - frameR, lineHeight,
+			           palette().color(QPalette::Highlight));
+			p.setPen(palette().color(QPalette::HighlightedText));
+		} else {
+			p.setPen(s.fontColor(Settings::CODE_FONT));
+		}
+
+		p.drawText(xIndex, y + lineAscent, QString::number(line));
+		hexStr.sprintf("%04X", pc);
+		p.drawText(xAddr, y + lineAscent, hexStr);
+		if (label) {
+			p.drawText(QRect(xLabel, y, xMCode - xLabel - 4, lineHeight),
+			           Qt::AlignLeft | Qt::AlignVCenter,
+			           p.fontMetrics().elidedText(label->instr.c_str(),
+			                                      Qt::ElideRight, xMCode - xLabel - 4));
+		}
+		hexStr.clear();
+		for (int i = 0; i < instr->numBytes; ++i) {
+			hexStr += QString("%1 ").arg((opcode >> (8 * i)) & 0xFF, 2, 16, QChar('0'));
+		}
+		p.drawText(xMCode, y + lineAscent, hexStr.toUpper());
+		p.drawText(xMnem, y + lineAscent, instr->instr.substr(0, 7).c_str());
+		p.drawText(xMnemArg, y + lineAscent, instr->instr.substr(7).c_str());
+		for (int r = 0; r < TraceBuffer::NUM_REGS; ++r) {
+			hexStr.sprintf("%s=%04X", regNames[r],
+			               trace->reg(line, TraceBuffer::Register(r)));
+			p.drawText(xRegs + r * regWidth, y + lineAscent, hexStr);
+		}
+	}
+}
+
+void TraceListView::keyPressEvent(QKeyEvent* e)
+{
+	switch (e->key()) {
+	case Qt::Key_Up:
+		setCursorLine(cursorLine - 1);
+		break;
+	case Qt::Key_Down:
+		setCursorLine(cursorLine + 1);
+		break;
+	case Qt::Key_PageUp:
+		setCursorLine(cursorLine - visibleLines);
+		break;
+	case Qt::Key_PageDown:
+		setCursorLine(cursorLine + visibleLines);
+		break;
+	case Qt::Key_Home:
+		setCursorLine(0);
+		break;
+	case Qt::Key_End:
+		setCursorLine(trace ? trace->size() - 1 : 0);
+		break;
+	case Qt::Key_Return:
+		if (trace && cursorLine < trace->size()) {
+			emit jumpToAddress(trace->pc(cursorLine));
+		}
+		break;
+	default:
+		QFrame::keyPressEvent(e);
+		return;
+	}
+	e->accept();
+}
+
+void TraceListView::mousePressEvent(QMouseEvent* e)
+{
+	if (e->button() == Qt::LeftButton) {
+		setCursorLine(topLine + (e->y() - frameT) / lineHeight);
+	}
+	QFrame::mousePressEvent(e);
+}
+
+void TraceListView::mouseDoubleClickEvent(QMouseEvent* e)
+{
+	if (e->button() == Qt::LeftButton && trace && cursorLine < trace->size()) {
+		emit jumpToAddress(trace->pc(cursorLine));
+	}
+}
+
+void TraceListView::wheelEvent(QWheelEvent* e)
+{
+	if (e->orientation() == Qt::Vertical) {
+		setTopLine(topLine - e->delta() / 40);
+		e->accept();
+	}
+}
+
+
+TraceViewer::TraceViewer(QWidget* parent)
+	: QWidget(parent)
+{
+	recordButton = new QPushButton(tr("Record"));
+	recordButton->setCheckable(true);
+	clearButton = new QPushButton(tr("Clear"));
+
+	countEdit = new QSpinBox();
+	countEdit->setRange(1, 100000000);
+	countEdit->setValue(10000);
+	countEdit->setSuffix(tr(" instructions"));
+
+	breakCheck = new QCheckBox(tr("Break when done"));
+	breakCheck->setChecked(true);
+
+	totalLabel = new QLabel();
+	listView = new TraceListView();
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->setMargin(0);
+	hbox->addWidget(recordButton);
+	hbox->addWidget(countEdit);
+	hbox->addWidget(breakCheck);
+	hbox->addWidget(clearButton);
+	hbox->addStretch();
+	hbox->addWidget(totalLabel);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->setMargin(0);
+	vbox->addLayout(hbox);
+	vbox->addWidget(listView);
+	setLayout(vbox);
+
+	recorder = 0;
+	trace = 0;
+
+	connect(recordButton, SIGNAL(toggled(bool)), this, SLOT(startStop(bool)));
+	connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+	connect(listView, SIGNAL(jumpToAddress(quint16)),
+	        this, SIGNAL(jumpToAddress(quint16)));
+}
+
+void TraceViewer::setRecorder(TraceRecorder* r, const TraceBuffer* buf)
+{
+	recorder = r;
+	trace = buf;
+	listView->setTraceBuffer(buf);
+	connect(recorder, SIGNAL(traceChanged()), this, SLOT(traceChanged()));
+	connect(recorder, SIGNAL(runningChanged(bool)), this, SLOT(runningChanged(bool)));
+	runningChanged(recorder->isRunning());
+	traceChanged();
+}
+
+void TraceViewer::setSymbolTable(SymbolTable* st)
+{
+	listView->setSymbolTable(st);
+}
+
+void TraceViewer::setMemoryLayout(MemoryLayout* ml)
+{
+	listView->setMemoryLayout(ml);
+}
+
+void TraceViewer::settingsChanged()
+{
+	listView->settingsChanged();
+}
+
+void TraceViewer::startStop(bool checked)
+{
+	if (!recorder || checked == recorder->isRunning()) return;
+	if (checked) {
+		recorder->start(countEdit->value(), breakCheck->isChecked());
+	} else {
+		recorder->stop();
+	}
+}
+
+void TraceViewer::runningChanged(bool running)
+{
+	recordButton->setChecked(running);
+	countEdit->setEnabled(!running);
+	breakCheck->setEnabled(!running);
+}
+
+void TraceViewer::traceChanged()
+{
+	if (!trace) return;
+	QString text = tr("%1 entries").arg(trace->size());
+	if (trace->totalCount() > quint64(trace->size())) {
+		text += tr(" (%1 dropped)").arg(trace->totalCount() - trace->size());
+	}
+	totalLabel->setText(text);
+	listView->traceChanged();
+}
+
+void TraceViewer::clear()
+{
+	if (recorder) recorder->clear();
+}
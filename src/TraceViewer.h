@@ -0,0 +1,109 @@
+#ifndef TRACEVIEWER_H
+#define TRACEVIEWER_H
+
+#include "Dasm.h"
+#include <QFrame>
+#include <QWidget>
+
+class TraceBuffer;
+class TraceRecorder;
+class SymbolTable;
+struct MemoryLayout;
+class QCheckBox;
+class QLabel;
+class QPushButton;
+class QScrollBar;
+class QSpinBox;
+
+/** Shows the recorded trace. Only the visible rows are disassembled and
+  * painted, so scrolling through millions of entries costs nothing extra.
+  */
+class TraceListView : public QFrame
+{
+	Q_OBJECT
+public:
+	TraceListView(QWidget* parent = 0);
+
+	void setTraceBuffer(const TraceBuffer* buf);
+	void setSymbolTable(SymbolTable* st);
+	void setMemoryLayout(MemoryLayout* ml);
+
+	QSize sizeHint() const;
+
+public slots:
+	void traceChanged();
+	void settingsChanged();
+	void scrollToEnd();
+
+private slots:
+	void scrollBarChanged(int value);
+
+signals:
+	void jumpToAddress(quint16 addr);
+
+private:
+	void resizeEvent(QResizeEvent* e);
+	void paintEvent(QPaintEvent* e);
+	void keyPressEvent(QKeyEvent* e);
+	void mousePressEvent(QMouseEvent* e);
+	void mouseDoubleClickEvent(QMouseEvent* e);
+	void wheelEvent(QWheelEvent* e);
+
+	void setTopLine(int line);
+	void setCursorLine(int line);
+	void updateScrollBar();
+
+	QScrollBar* scrollBar;
+
+	// layout information
+	int frameL, frameR, frameT, frameB;
+	int lineHeight, lineAscent;
+	int xIndex, xAddr, xLabel, xMCode, xMnem, xMnemArg, xRegs, regWidth;
+	int visibleLines;
+
+	const TraceBuffer* trace;
+	SymbolTable* symTable;
+	MemoryLayout* memLayout;
+	int topLine;
+	int cursorLine;
+
+	// dasm() reads from a 64kB buffer, opcodes are copied in here
+	unsigned char dasmMemory[65536 + 4];
+	DisasmLines dasmLines;
+};
+
+class TraceViewer : public QWidget
+{
+	Q_OBJECT
+public:
+	TraceViewer(QWidget* parent = 0);
+
+	void setRecorder(TraceRecorder* r, const TraceBuffer* buf);
+	void setSymbolTable(SymbolTable* st);
+	void setMemoryLayout(MemoryLayout* ml);
+
+public slots:
+	void settingsChanged();
+
+private slots:
+	void startStop(bool checked);
+	void runningChanged(bool running);
+	void traceChanged();
+	void clear();
+
+signals:
+	void jumpToAddress(quint16 addr);
+
+private:
+	QPushButton* recordButton;
+	QPushButton* clearButton;
+	QSpinBox* countEdit;
+	QCheckBox* breakCheck;
+	QLabel* totalLabel;
+	TraceListView* listView;
+
+	TraceRecorder* recorder;
+	const TraceBuffer* trace;
+};
+
+#endif // TRACEVIEWER_H
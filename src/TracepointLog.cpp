@@ -0,0 +1,135 @@
+#include "TracepointLog.h"
+#include "CommClient.h"
+#include "OpenMSXConnection.h"
+#include "DebuggerData.h"
+
+// log lines kept in the debugger
+static const int MAX_LOG_LINES = 10000;
+// maximum size of the log buffered in openMSX between two fetches
+static const int LOG_BUFFER_SIZE = 1 << 20;
+
+
+TracepointLog::TracepointLog(Breakpoints& breakpoints_, QObject* parent)
+	: QObject(parent)
+	, breakpoints(breakpoints_)
+	, fetcher("debug_tracepoint_fetch",
+	          [this](const QString& data) { addData(data); })
+{
+	connected = false;
+
+	fetchTimer.setInterval(500);
+	connect(&fetchTimer, SIGNAL(timeout()), this, SLOT(fetch()));
+	connect(&CommClient::instance(), SIGNAL(connectionTerminated()),
+	        this, SLOT(connectionClosed()));
+}
+
+const QList<quint16>& TracepointLog::addresses() const
+{
+	return tracepoints;
+}
+
+quint32 TracepointLog::hits(quint16 addr) const
+{
+	return hitCounts.value(addr, 0);
+}
+
+const QStringList& TracepointLog::entries() const
+{
+	return log;
+}
+
+void TracepointLog::start()
+{
+	// the message is substituted globally so it can use any variable;
+	// errors are logged instead of being reported on every hit
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_tracepoint { msg } {\n"
+		"  set pc [reg PC]\n"
+		"  incr ::debug_tp_hits($pc)\n"
+		"  if { [string length $::debug_tp_log] &lt; " + QString::number(LOG_BUFFER_SIZE) + " } {\n"
+		"    if { [catch { uplevel #0 [list subst $msg] } text] } {\n"
+		"      set text \"error: $text\"\n"
+		"    }\n"
+		"    append ::debug_tp_log [format %04X $pc] \" \" [string map {\"\\n\" \" \"} $text] \"\\n\"\n"
+		"  }\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_tracepoint_fetch { } {\n"
+		"  set result [array get ::debug_tp_hits]\n"
+		"  append result \"\\n\" $::debug_tp_log\n"
+		"  set ::debug_tp_log \"\"\n"
+		"  return $result\n"
+		"}\n"
+		"if { ![info exists ::debug_tp_log] } { set ::debug_tp_log \"\" }\n"));
+
+	connected = true;
+	fetchTimer.start();
+}
+
+void TracepointLog::clear()
+{
+	if (connected) {
+		CommClient::instance().sendCommand(new SimpleCommand(
+			"array unset ::debug_tp_hits\n"
+			"set ::debug_tp_log \"\""));
+	}
+	hitCounts.clear();
+	log.clear();
+	emit logCleared();
+	emit hitsChanged();
+}
+
+void TracepointLog::fetch()
+{
+	if (!connected) return;
+	// nothing to collect without tracepoints
+	if (breakpoints.tracepointAddresses().isEmpty()) {
+		if (!tracepoints.isEmpty()) {
+			tracepoints.clear();
+			emit hitsChanged();
+		}
+		return;
+	}
+	fetcher.fetch();
+}
+
+void TracepointLog::connectionClosed()
+{
+	connected = false;
+	fetchTimer.stop();
+}
+
+void TracepointLog::addData(const QString& data)
+{
+	// first line holds address/count pairs, the log lines follow
+	int p = data.indexOf('\n');
+	if (p == -1) p = data.size();
+	bool changed = false;
+
+	QStringList counts = data.left(p).split(' ', QString::SkipEmptyParts);
+	for (int i = 0; i + 1 < counts.size(); i += 2) {
+		int addr = counts[i].toInt();
+		quint32 n = counts[i + 1].toUInt();
+		quint32& old = hitCounts[addr];
+		if (old != n) {
+			old = n;
+			changed = true;
+		}
+	}
+
+	QList<quint16> addrs = breakpoints.tracepointAddresses();
+	if (addrs != tracepoints) {
+		tracepoints = addrs;
+		changed = true;
+	}
+	if (changed) emit hitsChanged();
+
+	QStringList lines = data.mid(p + 1).split('\n', QString::SkipEmptyParts);
+	if (lines.isEmpty()) return;
+	log += lines;
+	if (log.size() > MAX_LOG_LINES) {
+		log.erase(log.begin(), log.begin() + (log.size() - MAX_LOG_LINES));
+	}
+	emit entriesAdded(lines);
+}
@@ -0,0 +1,57 @@
+#ifndef TRACEPOINTLOG_H
+#define TRACEPOINTLOG_H
+
+#include "OpenMSXConnection.h"
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+
+class Breakpoints;
+
+/** Collects the output of tracepoints.
+  * A tracepoint is a breakpoint whose command appends a message to a log
+  * and counts the hit in openMSX instead of breaking, so the emulation
+  * keeps running. The log and the hit counters are fetched in batches
+  * while there are tracepoints.
+  */
+class TracepointLog : public QObject
+{
+	Q_OBJECT
+public:
+	TracepointLog(Breakpoints& breakpoints, QObject* parent = 0);
+
+	// tracepoint addresses as of the last fetch
+	const QList<quint16>& addresses() const;
+	quint32 hits(quint16 addr) const;
+	// most recent log lines, oldest first
+	const QStringList& entries() const;
+
+public slots:
+	void start();
+	void clear();
+	void fetch();
+
+signals:
+	void hitsChanged();
+	void entriesAdded(const QStringList& lines);
+	void logCleared();
+
+private slots:
+	void connectionClosed();
+
+private:
+	void addData(const QString& data);
+
+	Breakpoints& breakpoints;
+	QList<quint16> tracepoints;
+	QHash<int, quint32> hitCounts;
+	QStringList log;
+
+	bool connected;
+	SingleFetch fetcher;
+	QTimer fetchTimer;
+};
+
+#endif // TRACEPOINTLOG_H
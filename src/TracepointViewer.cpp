@@ -0,0 +1,136 @@
+#include "TracepointViewer.h"
+#include "TracepointLog.h"
+#include "SymbolTable.h"
+#include "Settings.h"
+#include "Convert.h"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+// lines shown in the log view, older ones are dropped
+static const int MAX_SHOWN_LINES = 10000;
+
+TracepointViewer::TracepointViewer(QWidget* parent)
+	: QWidget(parent)
+{
+	clearButton = new QPushButton(tr("Clear"));
+	clearButton->setToolTip(tr("Clear the log and reset the hit counters"));
+	countLabel = new QLabel();
+
+	pointList = new QTreeWidget();
+	pointList->setRootIsDecorated(false);
+	pointList->setColumnCount(3);
+	pointList->setHeaderLabels(QStringList() << tr("Address") << tr("Label")
+	                                         << tr("Hits"));
+	pointList->setSortingEnabled(true);
+	pointList->sortByColumn(0, Qt::AscendingOrder);
+
+	logView = new QPlainTextEdit();
+	logView->setReadOnly(true);
+	logView->setLineWrapMode(QPlainTextEdit::NoWrap);
+	logView->setMaximumBlockCount(MAX_SHOWN_LINES);
+
+	QSplitter* splitter = new QSplitter(Qt::Vertical);
+	splitter->addWidget(pointList);
+	splitter->addWidget(logView);
+	splitter->setStretchFactor(1, 1);
+
+	QHBoxLayout* hbox = new QHBoxLayout();
+	hbox->setMargin(0);
+	hbox->addWidget(clearButton);
+	hbox->addStretch();
+	hbox->addWidget(countLabel);
+
+	QVBoxLayout* vbox = new QVBoxLayout();
+	vbox->setMargin(0);
+	vbox->addLayout(hbox);
+	vbox->addWidget(splitter);
+	setLayout(vbox);
+
+	log = 0;
+	symTable = 0;
+	memLayout = 0;
+
+	settingsChanged();
+
+	connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+	connect(pointList, SIGNAL(itemActivated(QTreeWidgetItem*, int)),
+	        this, SLOT(itemActivated(QTreeWidgetItem*)));
+}
+
+void TracepointViewer::setLog(TracepointLog* l)
+{
+	log = l;
+	connect(log, SIGNAL(hitsChanged()), this, SLOT(refresh()));
+	connect(log, SIGNAL(entriesAdded(const QStringList&)),
+	        this, SLOT(addEntries(const QStringList&)));
+	connect(log, SIGNAL(logCleared()), this, SLOT(clearEntries()));
+	addEntries(log->entries());
+}
+
+void TracepointViewer::setSymbolTable(SymbolTable* st)
+{
+	symTable = st;
+}
+
+void TracepointViewer::setMemoryLayout(MemoryLayout* ml)
+{
+	memLayout = ml;
+}
+
+void TracepointViewer::settingsChanged()
+{
+	logView->setFont(Settings::get().font(Settings::CODE_FONT));
+}
+
+void TracepointViewer::refresh()
+{
+	if (!log) return;
+
+	pointList->setSortingEnabled(false);
+	pointList->clear();
+	const QList<quint16>& addrs = log->addresses();
+	for (QList<quint16>::const_iterator it = addrs.begin(); it != addrs.end(); ++it) {
+		QTreeWidgetItem* item = new QTreeWidgetItem(pointList);
+		item->setText(0, hexValue(*it, 4).toUpper());
+		item->setData(0, Qt::UserRole, *it);
+		if (symTable) {
+			if (Symbol* sym = symTable->getAddressSymbol(*it, memLayout)) {
+				item->setText(1, sym->text());
+			}
+		}
+		// store numbers so sorting isn't alphabetical
+		item->setData(2, Qt::DisplayRole, log->hits(*it));
+		item->setTextAlignment(2, Qt::AlignRight);
+	}
+	pointList->setSortingEnabled(true);
+}
+
+void TracepointViewer::addEntries(const QStringList& lines)
+{
+	if (lines.isEmpty()) return;
+	for (QStringList::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+		logView->appendPlainText(*it);
+	}
+	countLabel->setText(tr("%1 log lines").arg(logView->blockCount()));
+}
+
+void TracepointViewer::clearEntries()
+{
+	logView->clear();
+	countLabel->clear();
+}
+
+void TracepointViewer::clear()
+{
+	if (log) log->clear();
+}
+
+void TracepointViewer::itemActivated(QTreeWidgetItem* item)
+{
+	emit jumpToAddress(item->data(0, Qt::UserRole).toInt());
+}
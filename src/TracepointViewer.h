@@ -0,0 +1,49 @@
+#ifndef TRACEPOINTVIEWER_H
+#define TRACEPOINTVIEWER_H
+
+#include <QWidget>
+
+class TracepointLog;
+class SymbolTable;
+struct MemoryLayout;
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+class TracepointViewer : public QWidget
+{
+	Q_OBJECT
+public:
+	TracepointViewer(QWidget* parent = 0);
+
+	void setLog(TracepointLog* l);
+	void setSymbolTable(SymbolTable* st);
+	void setMemoryLayout(MemoryLayout* ml);
+
+public slots:
+	void refresh();
+	void settingsChanged();
+
+private slots:
+	void addEntries(const QStringList& lines);
+	void clearEntries();
+	void clear();
+	void itemActivated(QTreeWidgetItem* item);
+
+signals:
+	void jumpToAddress(quint16 addr);
+
+private:
+	QPushButton* clearButton;
+	QLabel* countLabel;
+	QTreeWidget* pointList;
+	QPlainTextEdit* logView;
+
+	TracepointLog* log;
+	SymbolTable* symTable;
+	MemoryLayout* memLayout;
+};
+
+#endif // TRACEPOINTVIEWER_H
@@ -1,51 +1,38 @@
 #include "VDPDataStore.h"
 #include "CommClient.h"
+#include "Convert.h"
+#include <algorithm>
+#include <cstring>
 
-class VDPDataStoreVersionCheck : public SimpleCommand
+/** Finds out the name and the size of the VRAM debuggable in one round
+  * trip. Newer openMSX versions have "physical VRAM", older ones "VRAM".
+  */
+class VDPDataStoreProbe : public SimpleCommand
 {
 public:
-	VDPDataStoreVersionCheck(VDPDataStore& dataStore_)
-		: SimpleCommand("debug desc {physical VRAM}")
+	VDPDataStoreProbe(VDPDataStore& dataStore_)
+		: SimpleCommand(
+			"set ::debug_vdp_vram VRAM\n"
+			"if {{physical VRAM} in [debug list]} {set ::debug_vdp_vram {physical VRAM}}\n"
+			"format {%d %s} [debug size $::debug_vdp_vram] $::debug_vdp_vram")
 		, dataStore(dataStore_)
 	{
 	}
 
 	virtual void replyOk(const QString& message)
 	{
-		dataStore.debuggableNameVRAM = "physical VRAM";
-		dataStore.got_version = true;
-		dataStore.refresh();
+		int p = message.indexOf(' ');
+		dataStore.probeDone(message.mid(p + 1), message.left(p).toInt());
 		delete this;
 	}
 	virtual void replyNok(const QString& message)
 	{
-		dataStore.debuggableNameVRAM = "VRAM";
-		dataStore.got_version = true;
-		dataStore.refresh();
+		dataStore.probeDone(QString(), 0);
 		delete this;
 	}
-
-private:
-	VDPDataStore& dataStore;
-};
-
-class VDPDataStoreVRAMSizeCheck : public SimpleCommand
-{
-public:
-	VDPDataStoreVRAMSizeCheck(VDPDataStore& dataStore_)
-		: SimpleCommand("debug size {" + QString::fromStdString(dataStore_.debuggableNameVRAM) + "}")
-		, dataStore(dataStore_)
-	{
-	}
-
-	virtual void replyOk(const QString& message)
-	{
-		dataStore.vramSize = message.toInt();
-		dataStore.refresh2();
-		delete this;
-	}
-	virtual void replyNok(const QString& message)
+	virtual void cancel()
 	{
+		dataStore.probeDone(QString(), 0);
 		delete this;
 	}
 
@@ -56,18 +43,49 @@ private:
 
 static const unsigned MAX_VRAM_SIZE = 0x30000;
 static const unsigned MAX_TOTAL_SIZE = MAX_VRAM_SIZE + 32 + 16 + 64 + 2;
+// VRAM is compared in blocks of this size, one line in screen 5 and 6
+static const unsigned DIRTY_BLOCK_SIZE = 128;
+
+// stops the frame hook of live mode, also one that was left running by
+// a previous connection
+static void cancelFrameHook()
+{
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"set ::debug_vdp_live 0\n"
+		"if {[info exists ::debug_vdp_frame_id]} {after cancel $::debug_vdp_frame_id}"));
+}
 
 VDPDataStore::VDPDataStore()
+	: liveFetcher("debug_vdp_fetch",
+	              [this](const QString& message) { liveFetchDone(message); })
 {
 	vram = new unsigned char[MAX_TOTAL_SIZE];
 	memset(vram, 0x00, MAX_TOTAL_SIZE);
+	previous = new unsigned char[MAX_TOTAL_SIZE];
+	previousVramSize = 0;
+	havePrevious = false;
+	vramSize = 0;
 	got_version = false;
-	CommClient::instance().sendCommand(new VDPDataStoreVersionCheck(*this));
+	probing = false;
+	live = false;
+	liveRequested = 0;
+	liveInterval = 40;
+	probe();
+
+	connect(&liveTimer, SIGNAL(timeout()), this, SLOT(liveFetch()));
+	connect(&CommClient::instance(), SIGNAL(connectionReady()),
+	        this, SLOT(connectionOpened()));
+	connect(&CommClient::instance(), SIGNAL(connectionTerminated()),
+	        this, SLOT(connectionClosed()));
+	connect(&CommClient::instance(),
+	        SIGNAL(updateParsed(const QString&, const QString&, const QString&)),
+	        this, SLOT(handleUpdate(const QString&, const QString&, const QString&)));
 }
 
 VDPDataStore::~VDPDataStore()
 {
 	delete[] vram;
+	delete[] previous;
 }
 
 VDPDataStore& VDPDataStore::instance()
@@ -78,14 +96,67 @@ VDPDataStore& VDPDataStore::instance()
 
 void VDPDataStore::refresh()
 {
-	if (!got_version) return;
+	// the debuggable is only probed again after a machine change, so a
+	// refresh normally is a single request
+	if (!got_version) {
+		// the probe fetches the data once it knows the debuggable
+		probe();
+		return;
+	}
+	refresh2();
+}
+
+void VDPDataStore::probe()
+{
+	if (probing) return;
+	probing = true;
+	CommClient::instance().sendCommand(new VDPDataStoreProbe(*this));
+}
 
-	refresh1();
+void VDPDataStore::probeDone(const QString& name, int size)
+{
+	probing = false;
+	if (name.isEmpty() || size <= 0 || unsigned(size) > MAX_VRAM_SIZE) {
+		// no VDP, or no connection yet
+		if (liveRequested) {
+			liveRequested = 0;
+			emit liveChanged(false);
+		}
+		return;
+	}
+	debuggableNameVRAM = name.toStdString();
+	vramSize = size;
+	got_version = true;
+	refresh2();
+	if (liveRequested) {
+		int fps = liveRequested;
+		liveRequested = 0;
+		startLive(fps);
+	}
 }
 
-void VDPDataStore::refresh1()
+void VDPDataStore::machineChanged()
 {
-	CommClient::instance().sendCommand(new VDPDataStoreVRAMSizeCheck(*this));
+	got_version = false;
+	havePrevious = false;
+	history.clear();
+	// the frame hook reads the old machine's debuggable
+	stopLive();
+	probe();
+}
+
+void VDPDataStore::connectionOpened()
+{
+	// a live hook of an earlier connection may still be running
+	cancelFrameHook();
+	machineChanged();
+}
+
+void VDPDataStore::handleUpdate(const QString& type, const QString& name,
+                                const QString& message)
+{
+	// machines being added, removed or selected
+	if (type == "hardware") machineChanged();
 }
 
 void VDPDataStore::refresh2()
@@ -102,9 +173,167 @@ void VDPDataStore::refresh2()
 
 void VDPDataStore::DataHexRequestReceived()
 {
+	dataReceived();
+}
+
+void VDPDataStore::dataReceived()
+{
+	const unsigned char* oldVram = previous;
+	const unsigned char* oldRest = previous + previousVramSize;
+	const unsigned char* rest = vram + vramSize;
+	bool all = !havePrevious || vramSize != previousVramSize;
+
+	QList<VramRange> ranges;
+	if (all) {
+		VramRange r = { 0, unsigned(vramSize) };
+		ranges.append(r);
+	} else {
+		for (unsigned addr = 0; addr < vramSize; addr += DIRTY_BLOCK_SIZE) {
+			unsigned len = std::min<unsigned>(DIRTY_BLOCK_SIZE, vramSize - addr);
+			if (memcmp(vram + addr, oldVram + addr, len) == 0) continue;
+			if (!ranges.isEmpty() && ranges.last().last == addr) {
+				ranges.last().last = addr + len;
+			} else {
+				VramRange r = { addr, addr + len };
+				ranges.append(r);
+			}
+		}
+	}
+	bool palette = all || memcmp(rest,      oldRest,      32) != 0;
+	bool status  = all || memcmp(rest + 32, oldRest + 32, 16) != 0;
+	bool regs    = all || memcmp(rest + 48, oldRest + 48, 64) != 0;
+	bool pointer = all || memcmp(rest + 112, oldRest + 112, 2) != 0;
+
+	memcpy(previous, vram, MAX_TOTAL_SIZE - MAX_VRAM_SIZE + vramSize);
+	previousVramSize = vramSize;
+	havePrevious = true;
+	history.add(vram, MAX_TOTAL_SIZE - MAX_VRAM_SIZE + vramSize);
+
+	// the registers and palette first, they decide how vram is shown
+	if (regs) emit regsChanged();
+	if (palette) emit paletteChanged();
+	if (status) emit statusRegsChanged();
+	if (!ranges.isEmpty()) emit vramChanged(ranges);
+	if (!ranges.isEmpty() || palette || regs || status || pointer) {
+		emit dataChanged();
+	}
 	emit dataRefreshed();
 }
 
+void VDPDataStore::startLive(int fps)
+{
+	if (!got_version) {
+		// started once the debuggable is known
+		liveRequested = fps;
+		probe();
+		return;
+	}
+	liveInterval = 1000 / std::max(1, std::min(60, fps));
+	liveTimer.setInterval(liveInterval);
+	if (live) return;
+
+	// the frame hook only copies the data when a fetch asked for it, so
+	// an idle viewer doesn't slow down the emulation
+	QString name = QString::fromStdString(debuggableNameVRAM);
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_vdp_frame { } {\n"
+		"  if {!$::debug_vdp_live} return\n"
+		"  if {$::debug_vdp_armed} {\n"
+		"    set ::debug_vdp_armed 0\n"
+		"    set ::debug_vdp_snapshot [debug_bin2hex "
+		"[debug read_block {" + name + "} 0 [debug size {" + name + "}]]"
+		"[debug read_block {VDP palette} 0 32]"
+		"[debug read_block {VDP status regs} 0 16]"
+		"[debug read_block {VDP regs} 0 64]"
+		"[debug read_block {VRAM pointer} 0 2]]\n"
+		"  }\n"
+		"  set ::debug_vdp_frame_id [after frame debug_vdp_frame]\n"
+		"}\n"));
+
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"proc debug_vdp_fetch { } {\n"
+		"  set result $::debug_vdp_snapshot\n"
+		"  set ::debug_vdp_snapshot \"\"\n"
+		"  set ::debug_vdp_armed 1\n"
+		"  return $result\n"
+		"}\n"));
+
+	// there is never more than one hook running
+	cancelFrameHook();
+	CommClient::instance().sendCommand(new SimpleCommand(
+		"set ::debug_vdp_snapshot \"\"\n"
+		"set ::debug_vdp_armed 1\n"
+		"set ::debug_vdp_live 1\n"
+		"set ::debug_vdp_frame_id [after frame debug_vdp_frame]"));
+
+	live = true;
+	liveTimer.start();
+	emit liveChanged(true);
+}
+
+void VDPDataStore::stopLive()
+{
+	if (!live) {
+		if (liveRequested) {
+			liveRequested = 0;
+			emit liveChanged(false);
+		}
+		return;
+	}
+	cancelFrameHook();
+	live = false;
+	liveTimer.stop();
+	emit liveChanged(false);
+}
+
+bool VDPDataStore::isLive() const
+{
+	return live;
+}
+
+void VDPDataStore::liveFetch()
+{
+	// a frame is dropped rather than queueing requests behind a slow reply
+	if (liveFetcher.isFetching()) return;
+	liveLag.start();
+	liveFetcher.fetch();
+}
+
+void VDPDataStore::liveFetchDone(const QString& message)
+{
+	liveDataReceived(message);
+	if (!live) return;
+	// don't ask more often than openMSX and the connection can answer
+	liveTimer.setInterval(std::max(liveInterval, int(liveLag.elapsed())));
+}
+
+void VDPDataStore::liveDataReceived(const QString& message)
+{
+	// empty when no frame was emulated since the previous fetch
+	unsigned size = message.size() / 2;
+	if (size <= MAX_TOTAL_SIZE - MAX_VRAM_SIZE) return;
+	unsigned newVramSize = size - (MAX_TOTAL_SIZE - MAX_VRAM_SIZE);
+	if (newVramSize > MAX_VRAM_SIZE) return;
+
+	vramSize = newVramSize;
+	hexToBytes(message.constData(), size, vram);
+	dataReceived();
+}
+
+void VDPDataStore::connectionClosed()
+{
+	// another machine may be connected next
+	got_version = false;
+	havePrevious = false;
+	history.clear();
+	// the hook can't be stopped any more, the next connection does that
+	if (!live && !liveRequested) return;
+	liveRequested = 0;
+	live = false;
+	liveTimer.stop();
+	emit liveChanged(false);
+}
+
 
 const unsigned char* VDPDataStore::getVramPointer() const
 {
@@ -131,3 +360,8 @@ const size_t VDPDataStore::getVRAMSize() const
 {
 	return vramSize;
 }
+
+VramHistory& VDPDataStore::getHistory()
+{
+	return history;
+}
@@ -2,9 +2,24 @@
 #define VDPDATASTORE_H
 
 #include "SimpleHexRequest.h"
+#include "VramHistory.h"
+#include "OpenMSXConnection.h"
 #include <QObject>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <string>
 
+/** A range [first, last) of changed bytes in the VRAM buffer. The
+  * addresses are those of the buffer, so for the physical VRAM the banks
+  * are not interleaved.
+  */
+struct VramRange
+{
+	unsigned first;
+	unsigned last;
+};
+
 class VDPDataStore : public QObject, public SimpleHexRequestUser
 {
 	Q_OBJECT
@@ -19,37 +34,81 @@ public:
 
 	const size_t getVRAMSize() const;
 
+	/** The data of the previous refreshes, laid out like the buffer
+	  * getVramPointer() points to.
+	  */
+	VramHistory& getHistory();
+
+	/** Live mode keeps fetching the data while the emulation runs, at
+	  * most fps times per second. openMSX takes the snapshot at the first
+	  * frame boundary after the previous fetch, so a fetch returns at most
+	  * one round trip old data of a whole frame. When the replies lag
+	  * behind, fetches are skipped and the rate is lowered.
+	  */
+	void startLive(int fps);
+	void stopLive();
+	bool isLive() const;
+
 private:
 	VDPDataStore();
 	~VDPDataStore();
 
 	virtual void DataHexRequestReceived();
 
-	void refresh1();
+	void probe();
+	void probeDone(const QString& name, int size);
 	void refresh2();
+	void liveDataReceived(const QString& message);
+	void liveFetchDone(const QString& message);
+	void dataReceived();
+
+	// the data of the previous refresh, to find out what changed
+	unsigned char* previous;
+	size_t previousVramSize;
+	bool havePrevious;
+	VramHistory history;
 
 	unsigned char* vram;
 	size_t vramSize;
 
+	// capabilities of the connected machine, kept until it changes
 	std::string debuggableNameVRAM; // VRAM debuggable name
-	bool got_version; // is the above boolean already filled in?
-	friend class VDPDataStoreVersionCheck;
-	friend class VDPDataStoreVRAMSizeCheck;
+	bool got_version; // are the above name and vramSize already filled in?
+	bool probing;
+
+	QTimer liveTimer;
+	QElapsedTimer liveLag;
+	int liveInterval; // ms
+	bool live;
+	SingleFetch liveFetcher;
+	// the fps of a start that waits for the probe, 0 if none
+	int liveRequested;
+
+	friend class VDPDataStoreProbe;
 
 public slots:
 	void refresh();
 
+private slots:
+	void liveFetch();
+	void machineChanged();
+	void connectionOpened();
+	void connectionClosed();
+	void handleUpdate(const QString& type, const QString& name,
+	                  const QString& message);
+
 signals:
         void dataRefreshed(); // The refresh got the new data
+	void liveChanged(bool live);
 
-	/** This might become handy later on, for now we only need the dataRefreshed
-	 *
+	/* Emitted after a refresh, before dataRefreshed, only for the parts
+	 * that differ from the previous refresh.
+	 */
 	void dataChanged(); //any of the contained data has changed
-	void vramChanged(); //only the vram changed
-	void paletteChanged(); //only the palette changed
-	void regsChanged(); //only the regs changed
-	void statusRegsChanged(); //only the regs changed
-	*/
+	void vramChanged(const QList<VramRange>& ranges); //the vram in these ranges changed
+	void paletteChanged(); //the palette changed
+	void regsChanged(); //the regs changed
+	void statusRegsChanged(); //the status regs changed
 };
 
 #endif /* VDPDATASTORE_H */
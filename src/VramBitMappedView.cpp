@@ -1,7 +1,9 @@
 #include "VramBitMappedView.h"
+#include <QPaintEvent>
 #include <QPainter>
+#include <QRunnable>
 #include <algorithm>
-#include <cstdio>
+#include <cstring>
 
 /** Clips x to the range [LO,HI].
   * Slightly faster than    std::min(HI, std::max(LO, x))
@@ -13,6 +15,11 @@ static inline int clip(int x)
 	return unsigned(x - LO) <= unsigned(HI - LO) ? x : (x < HI ? LO : HI);
 }
 
+// bytes of VRAM the bitmap modes can address
+static const int VRAM_SIZE = 0x20000;
+// smaller bands aren't worth a thread
+static const int MIN_BAND_LINES = 16;
+
 
 VramBitMappedView::VramBitMappedView(QWidget* parent)
 	: QWidget(parent)
@@ -23,10 +30,16 @@ VramBitMappedView::VramBitMappedView(QWidget* parent)
 	borderColor = 0;
 	pallet = NULL;
 	vramBase = NULL;
+	diffBase = NULL;
 	vramAddress = 0;
 	for (int i = 0; i < 15; ++i) {
 		msxpallet[i] = qRgb(80, 80, 80);
 	}
+	decoding = false;
+	decodedFirst = 0;
+	decodedLast = 0;
+	pendingFirst = 0;
+	pendingLast = 0;
 	setZoom(1.0f);
 
 	// mouse update events when mouse is moved over the image, Quibus likes this
@@ -34,44 +47,193 @@ VramBitMappedView::VramBitMappedView(QWidget* parent)
 	setMouseTracking(true);
 }
 
+VramBitMappedView::~VramBitMappedView()
+{
+	// the workers write into this view
+	pool.waitForDone();
+}
+
 void VramBitMappedView::setZoom(float zoom)
 {
 	zoomFactor = std::max(1.0f, zoom);
 	setFixedSize(int(512 * zoomFactor), int(lines * 2 * zoomFactor));
+	// only the shown image is scaled again, nothing is decoded
+	rescale();
 	update();
 }
 
+/** Decodes a band of lines into the back buffer, on a worker thread.
+  */
+class DecodeBandTask : public QRunnable
+{
+public:
+	DecodeBandTask(VramBitMappedView& view_, int first_, int last_)
+		: view(view_), first(first_), last(last_)
+	{
+	}
+
+	virtual void run()
+	{
+		view.decodeBand(first, last);
+	}
+
+private:
+	VramBitMappedView& view;
+	int first;
+	int last;
+};
+
 void VramBitMappedView::decode()
+{
+	decodeLines(0, lines);
+}
+
+void VramBitMappedView::decodeLines(int first, int last)
 {
 	if (!vramBase) return;
+	first = std::max(first, 0);
+	last = std::min(last, 256);
+	if (first >= last) return;
+	// a decode that is still running is finished first, the requests made
+	// meanwhile are merged into one
+	if (decoding) {
+		if (pendingFirst < pendingLast) {
+			pendingFirst = std::min(pendingFirst, first);
+			pendingLast  = std::max(pendingLast,  last);
+		} else {
+			pendingFirst = first;
+			pendingLast  = last;
+		}
+		return;
+	}
 
-	printf("\n"
-	       "screenMode: %i\n"
-	       "vram to start decoding: %i\n",
-	       screenMode, vramAddress);
-	switch (screenMode) {
+	copyState();
+
+	int count = last - first;
+	int bands = std::max(1, std::min(pool.maxThreadCount(),
+	                                 count / MIN_BAND_LINES));
+	// QImage is only reentrant, so the workers get the raw lines; bits()
+	// also detaches the back buffer here, on the GUI thread
+	state.bits = image.bits();
+	state.bytesPerLine = image.bytesPerLine();
+	decoding = true;
+	decodedFirst = first;
+	decodedLast = last;
+	bandsLeft.store(bands);
+	for (int i = 0; i < bands; ++i) {
+		pool.start(new DecodeBandTask(*this, first + count * i / bands,
+		                              first + count * (i + 1) / bands));
+	}
+}
+
+void VramBitMappedView::copyState()
+{
+	// the workers get their own copy of everything they read, so the
+	// settings and the data store can change while they run
+	state.vram = QByteArray(reinterpret_cast<const char*>(vramBase), VRAM_SIZE);
+	state.previous = diffBase
+	               ? QByteArray(reinterpret_cast<const char*>(diffBase), VRAM_SIZE)
+	               : QByteArray();
+	for (int i = 0; i < 16; ++i) {
+		state.pallet[i] = msxpallet[i];
+		state.colors[i] = getColor(i);
+	}
+	// a byte is expanded to all its pixels with a single lookup
+	for (int v = 0; v < 256; ++v) {
+		state.nibbles[v][0] = state.colors[v >> 4];
+		state.nibbles[v][1] = state.colors[v & 15];
+		for (int k = 0; k < 4; ++k) {
+			state.crumbs[v][k] = state.colors[(v >> (6 - 2 * k)) & 3];
+		}
+	}
+	state.vramAddress = vramAddress;
+	state.screenMode = screenMode;
+}
+
+void VramBitMappedView::decodeBand(int first, int last)
+{
+	switch (state.screenMode) {
 	case 12:
-		decodeSCR12();
+		decodeSCR12(state, first, last);
 		break;
 	case 11:
 	case 10:
-		decodeSCR10();
+		decodeSCR10(state, first, last);
 		break;
 	case 8:
-		decodeSCR8();
+		decodeSCR8(state, first, last);
 		break;
 	case 7:
-		decodeSCR7();
+		decodeSCR7(state, first, last);
 		break;
 	case 6:
-		decodeSCR6();
+		decodeSCR6(state, first, last);
 		break;
 	case 5:
-		decodeSCR5();
+		decodeSCR5(state, first, last);
 		break;
 	}
-	piximage = piximage.fromImage(image);
-	update();
+	if (!state.previous.isEmpty()) markChanges(state, first, last);
+	// the last band to finish hands the image to the GUI thread
+	if (!bandsLeft.deref()) {
+		QMetaObject::invokeMethod(this, "decodeFinished", Qt::QueuedConnection);
+	}
+}
+
+void VramBitMappedView::decodeFinished()
+{
+	decoding = false;
+	// only the decoded lines are copied and scaled
+	QRect area(0, 2 * decodedFirst, 512, 2 * (decodedLast - decodedFirst));
+	if (piximage.isNull()) {
+		piximage = QPixmap::fromImage(image);
+	} else {
+		QPainter qp(&piximage);
+		qp.drawImage(area.topLeft(), image, area);
+	}
+	updateScaled(area);
+	if (pendingFirst < pendingLast) {
+		int first = pendingFirst;
+		int last = pendingLast;
+		pendingFirst = pendingLast = 0;
+		decodeLines(first, last);
+	}
+}
+
+void VramBitMappedView::vramChanged(const QList<VramRange>& ranges)
+{
+	if (screenMode < 5) return;
+	// in screen 7 and up the bytes of the two 64kB banks are interleaved
+	bool interleaved = screenMode >= 7;
+	unsigned bytesPerLine = interleaved ? 256 : 128;
+	int first = lines;
+	int last = 0;
+	// adds the shown lines that hold the addresses [lo, hi)
+	auto addLines = [&](unsigned lo, unsigned hi) {
+		if (hi <= vramAddress) return;
+		unsigned l0 = (lo > vramAddress) ? (lo - vramAddress) / bytesPerLine : 0;
+		unsigned l1 = (hi - vramAddress + bytesPerLine - 1) / bytesPerLine;
+		first = std::min<int>(first, std::min<unsigned>(l0, lines));
+		last  = std::max<int>(last,  std::min<unsigned>(l1, lines));
+	};
+	for (int i = 0; i < ranges.size(); ++i) {
+		unsigned lo = ranges[i].first;
+		unsigned hi = ranges[i].last;
+		if (!interleaved) {
+			addLines(lo, hi);
+			continue;
+		}
+		// bank 0 holds the even addresses, bank 1 the odd ones
+		if (lo < 0x10000) {
+			addLines(2 * lo, 2 * std::min(hi, 0x10000u));
+		}
+		if (hi > 0x10000) {
+			lo = std::max(lo, 0x10000u) - 0x10000;
+			hi = std::min(hi, 0x20000u) - 0x10000;
+			if (lo < hi) addLines(2 * lo + 1, 2 * hi);
+		}
+	}
+	decodeLines(first, last);
 }
 
 void VramBitMappedView::decodePallet()
@@ -96,97 +258,157 @@ static unsigned interleave(unsigned x)
 	return (x >> 1) | ((x & 1) << 16);
 }
 
-void VramBitMappedView::setPixel2x2(int x, int y, QRgb c)
+/** The fixed colours of screen 8, 3 bits green and red, 2 bits blue.
+  */
+struct GRBColors
+{
+	GRBColors()
+	{
+		for (int val = 0; val < 256; ++val) {
+			int b = val & 0x03;
+			int r = val & 0x1C;
+			int g = val & 0xE0;
+			b = b | (b << 2) | (b << 4) | (b << 6);
+			r = (r >> 2) | r | (r << 3);
+			g = g | (g >> 3) | (g >> 6);
+			colors[val] = qRgb(r, g, b);
+		}
+	}
+	QRgb colors[256];
+};
+
+/** All colours of the YJK screens, indexed by the 5 bit Y of a pixel and
+  * the 6 bit J and K of its group of four pixels, see yjkIndex().
+  */
+struct YJKColors
+{
+	YJKColors()
+	{
+		for (int y = 0; y < 32; ++y) {
+			for (int j = -32; j < 32; ++j) {
+				for (int k = -32; k < 32; ++k) {
+					int r = clip<0, 31>(y + j);
+					int g = clip<0, 31>(y + k);
+					int b = clip<0, 31>((5 * y - 2 * j - k) / 4);
+					r = (r << 3) | (r >> 2);
+					b = (b << 3) | (b >> 2);
+					g = (g << 3) | (g >> 2);
+					colors[(y << 12) | ((j & 63) << 6) | (k & 63)] = qRgb(r, g, b);
+				}
+			}
+		}
+	}
+	QRgb colors[32 * 64 * 64];
+};
+
+// built on first use, it's shared by all views
+static const YJKColors& yjkColors()
+{
+	static const YJKColors table;
+	return table;
+}
+
+// the J and K part of the table index of a group of four pixels, the
+// low 3 bits of the bytes hold K (bytes 0 and 1) and J (bytes 2 and 3)
+static inline unsigned yjkIndex(const unsigned* p)
 {
-	image.setPixel(2 * x + 0, 2 * y + 0, c);
-	image.setPixel(2 * x + 1, 2 * y + 0, c);
-	image.setPixel(2 * x + 0, 2 * y + 1, c);
-	image.setPixel(2 * x + 1, 2 * y + 1, c);
+	return ((p[3] & 7) << 9) | ((p[2] & 7) << 6) | ((p[1] & 7) << 3) | (p[0] & 7);
 }
-void VramBitMappedView::setPixel1x2(int x, int y, QRgb c)
+
+// every MSX line is drawn on two image lines, the decoders write the
+// first one and then copy it (templates, because DecodeState is private)
+template <typename State>
+static inline QRgb* imageLine(const State& s, int y)
 {
-	image.setPixel(x, 2 * y + 0, c);
-	image.setPixel(x, 2 * y + 1, c);
+	return reinterpret_cast<QRgb*>(s.bits + 2 * y * s.bytesPerLine);
 }
 
-void VramBitMappedView::decodeSCR12()
+template <typename State>
+static inline void doubleLine(const State& s, int y)
 {
-	int offset = vramAddress;
-	for (int y = 0; y < lines; ++y) {
+	unsigned char* line = s.bits + 2 * y * s.bytesPerLine;
+	memcpy(line + s.bytesPerLine, line, s.bytesPerLine);
+}
+
+static inline const unsigned char* vramData(const QByteArray& vram)
+{
+	return reinterpret_cast<const unsigned char*>(vram.constData());
+}
+
+void VramBitMappedView::decodeSCR12(const DecodeState& s,
+                                    int first, int last)
+{
+	const YJKColors& yjk = yjkColors();
+	const unsigned char* vram = vramData(s.vram);
+	int offset = s.vramAddress + 256 * first;
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
 		for (int x = 0; x < 256; x += 4) {
 			unsigned p[4];
-			p[0] = vramBase[interleave(offset++)];
-			p[1] = vramBase[interleave(offset++)];
-			p[2] = vramBase[interleave(offset++)];
-			p[3] = vramBase[interleave(offset++)];
-			int j = (p[2] & 7) + ((p[3] & 3) << 3) - ((p[3] & 4) << 3);
-			int k = (p[0] & 7) + ((p[1] & 3) << 3) - ((p[1] & 4) << 3);
-
+			p[0] = vram[interleave(offset++)];
+			p[1] = vram[interleave(offset++)];
+			p[2] = vram[interleave(offset++)];
+			p[3] = vram[interleave(offset++)];
+			const QRgb* group = yjk.colors + yjkIndex(p);
 			for (unsigned n = 0; n < 4; ++n) {
-				int z = p[n] >> 3;
-				int r = clip<0, 31>(z + j);
-				int g = clip<0, 31>(z + k);
-				int b = clip<0, 31>((5 * z - 2 * j - k) / 4);
-				r = (r << 3) | (r >> 2);
-				b = (b << 3) | (b >> 2);
-				g = (g << 3) | (g >> 2);
-				setPixel2x2(x + n, y, qRgb(r, g, b));
+				QRgb c = group[(p[n] >> 3) << 12];
+				out[0] = c;
+				out[1] = c;
+				out += 2;
 			}
 		}
+		doubleLine(s, y);
 	}
 }
 
-void VramBitMappedView::decodeSCR10()
+void VramBitMappedView::decodeSCR10(const DecodeState& s,
+                                    int first, int last)
 {
-	int offset = vramAddress;
-	for (int y = 0; y < lines; ++y) {
+	const YJKColors& yjk = yjkColors();
+	const unsigned char* vram = vramData(s.vram);
+	int offset = s.vramAddress + 256 * first;
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
 		for (int x = 0; x < 256; x += 4) {
 			unsigned p[4];
-			p[0] = vramBase[interleave(offset++)];
-			p[1] = vramBase[interleave(offset++)];
-			p[2] = vramBase[interleave(offset++)];
-			p[3] = vramBase[interleave(offset++)];
-			int j = (p[2] & 7) + ((p[3] & 3) << 3) - ((p[3] & 4) << 3);
-			int k = (p[0] & 7) + ((p[1] & 3) << 3) - ((p[1] & 4) << 3);
-
+			p[0] = vram[interleave(offset++)];
+			p[1] = vram[interleave(offset++)];
+			p[2] = vram[interleave(offset++)];
+			p[3] = vram[interleave(offset++)];
+			const QRgb* group = yjk.colors + yjkIndex(p);
 			for (unsigned n = 0; n < 4; ++n) {
 				QRgb c;
 				if (p[n] & 0x08) {
 					// YAE
-					c = msxpallet[p[n] >> 4];
+					c = s.pallet[p[n] >> 4];
 				} else {
 					// YJK
-					int z = p[n] >> 3;
-					int r = clip<0, 31>(z + j);
-					int g = clip<0, 31>(z + k);
-					int b = clip<0, 31>((5 * z - 2 * j - k) / 4);
-					r = (r << 3) | (r >> 2);
-					b = (b << 3) | (b >> 2);
-					g = (g << 3) | (g >> 2);
-					c = qRgb(r, g, b);
+					c = group[(p[n] >> 3) << 12];
 				}
-				setPixel2x2(x + n, y, c);
+				out[0] = c;
+				out[1] = c;
+				out += 2;
 			}
 		}
+		doubleLine(s, y);
 	}
 }
 
-void VramBitMappedView::decodeSCR8()
+void VramBitMappedView::decodeSCR8(const DecodeState& s,
+                                   int first, int last)
 {
-	int offset = vramAddress;
-	for (int y = 0; y < lines; ++y) {
+	static const GRBColors grb;
+	const unsigned char* vram = vramData(s.vram);
+	int offset = s.vramAddress + 256 * first;
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
 		for (int x = 0; x < 256; ++x) {
-			unsigned char val = vramBase[interleave(offset++)];
-			int b = val & 0x03;
-			int r = val & 0x1C;
-			int g = val & 0xE0;
-
-			b = b | (b << 2) | (b << 4) | (b << 6);
-			r = (r >> 2) | r | (r << 3);
-			g = g | (g >> 3) | (g >> 6);
-
-			setPixel2x2(x, y, qRgb(r, g, b));
+			QRgb c = grb.colors[vram[interleave(offset++)]];
+			out[0] = c;
+			out[1] = c;
+			out += 2;
 		}
+		doubleLine(s, y);
 	}
 }
 
@@ -196,51 +418,147 @@ QRgb VramBitMappedView::getColor(int c)
 	return msxpallet[c ? c : borderColor];
 }
 
-void VramBitMappedView::decodeSCR7()
+void VramBitMappedView::decodeSCR7(const DecodeState& s,
+                                   int first, int last)
 {
-	int offset = vramAddress;
-	for (int y = 0; y < lines; ++y) {
+	const unsigned char* vram = vramData(s.vram);
+	int offset = s.vramAddress + 256 * first;
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
 		for (int x = 0; x < 512; x += 2) {
-			int val = vramBase[interleave(offset++)];
-			setPixel1x2(x + 0, y, getColor((val >> 4) & 15));
-			setPixel1x2(x + 1, y, getColor((val >> 0) & 15));
+			const QRgb* c = s.nibbles[vram[interleave(offset++)]];
+			out[0] = c[0];
+			out[1] = c[1];
+			out += 2;
 		}
+		doubleLine(s, y);
 	}
 }
 
-void VramBitMappedView::decodeSCR6()
+void VramBitMappedView::decodeSCR6(const DecodeState& s,
+                                   int first, int last)
 {
-	int offset = vramAddress;
-	for (int y = 0; y < lines; ++y) {
+	const unsigned char* in = vramData(s.vram) + s.vramAddress + 128 * first;
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
 		for (int x = 0; x < 512; x += 4) {
-			int val = vramBase[offset++];
-			setPixel1x2(x + 0, y, getColor((val >> 6) & 3));
-			setPixel1x2(x + 1, y, getColor((val >> 4) & 3));
-			setPixel1x2(x + 2, y, getColor((val >> 2) & 3));
-			setPixel1x2(x + 3, y, getColor((val >> 0) & 3));
+			const QRgb* c = s.crumbs[*in++];
+			out[0] = c[0];
+			out[1] = c[1];
+			out[2] = c[2];
+			out[3] = c[3];
+			out += 4;
 		}
+		doubleLine(s, y);
 	}
 }
 
-void VramBitMappedView::decodeSCR5()
+void VramBitMappedView::decodeSCR5(const DecodeState& s,
+                                   int first, int last)
 {
-	int offset = vramAddress;
-	for (int y = 0; y < lines; ++y) {
+	const unsigned char* in = vramData(s.vram) + s.vramAddress + 128 * first;
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
 		for (int x = 0; x < 256; x += 2) {
-			int val = vramBase[offset++];
-			setPixel2x2(x + 0, y, getColor((val >> 4) & 15));
-			setPixel2x2(x + 1, y, getColor((val >> 0) & 15));
+			const QRgb* c = s.nibbles[*in++];
+			out[0] = c[0];
+			out[1] = c[0];
+			out[2] = c[1];
+			out[3] = c[1];
+			out += 4;
 		}
+		doubleLine(s, y);
 	}
 }
 
-void VramBitMappedView::paintEvent(QPaintEvent* event)
+QRect VramBitMappedView::scaledRect(const QRect& area) const
 {
-	QRect srcRect(0, 0, 512, 2 * lines);
-	QRect dstRect(0, 0, int(512 * zoomFactor), int(2 * lines * zoomFactor));
+	int x0 = int(area.left() * zoomFactor);
+	int y0 = int(area.top()  * zoomFactor);
+	int x1 = int((area.right()  + 1) * zoomFactor);
+	int y1 = int((area.bottom() + 1) * zoomFactor);
+	return QRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+void VramBitMappedView::rescale()
+{
+	if (piximage.isNull()) return;
+	QRect area(0, 0, 512, 2 * lines);
+	scaled = QPixmap(scaledRect(area).size());
+	QPainter qp(&scaled);
+	qp.drawPixmap(scaled.rect(), piximage, area);
+}
+
+void VramBitMappedView::updateScaled(const QRect& area)
+{
+	QRect dst = scaledRect(area);
+	if (scaled.size() != scaledRect(QRect(0, 0, 512, 2 * lines)).size()) {
+		rescale();
+		update();
+		return;
+	}
+	QPainter qp(&scaled);
+	qp.drawPixmap(dst, piximage, area);
+	update(dst);
+}
+
+static inline QRgb dim(QRgb c)
+{
+	return ((c >> 2) & 0x3F3F3F) | 0xFF000000;
+}
+
+void VramBitMappedView::markChanges(const DecodeState& s,
+                                    int first, int last)
+{
+	bool interleaved = s.screenMode >= 7;
+	int bytesPerLine = interleaved ? 256 : 128;
+	int pixelsPerByte = (s.screenMode == 6) ? 4
+	                  : (s.screenMode == 5 || s.screenMode == 7) ? 2 : 1;
+	int bits = 8 / pixelsPerByte;
+	int pixelMask = (1 << bits) - 1;
+	// image pixels per MSX pixel
+	int width = 512 / (bytesPerLine * pixelsPerByte);
+	// the four pixels of a YJK group share their colour
+	int group = (s.screenMode >= 10) ? 4 : 1;
+
+	const unsigned char* vram = vramData(s.vram);
+	const unsigned char* prev = vramData(s.previous);
+	for (int y = first; y < last; ++y) {
+		QRgb* out = imageLine(s, y);
+		unsigned offset = s.vramAddress + bytesPerLine * y;
+		for (int i = 0; i < bytesPerLine; i += group) {
+			int diff[4];
+			int any = 0;
+			for (int g = 0; g < group; ++g) {
+				unsigned addr = offset + i + g;
+				if (interleaved) addr = interleave(addr);
+				diff[g] = vram[addr] ^ prev[addr];
+				any |= diff[g];
+			}
+			for (int g = 0; g < group; ++g) {
+				int changed = (group == 1) ? diff[g] : any;
+				QRgb* px = out + (i + g) * pixelsPerByte * width;
+				for (int k = 0; k < pixelsPerByte; ++k) {
+					bool hit = (changed >> (8 - bits * (k + 1))) & pixelMask;
+					if (!hit) {
+						for (int w = 0; w < width; ++w) {
+							px[w] = dim(px[w]);
+						}
+					}
+					px += width;
+				}
+			}
+		}
+		doubleLine(s, y);
+	}
+}
+
+void VramBitMappedView::paintEvent(QPaintEvent* e)
+{
+	if (scaled.isNull()) return;
+	// the zoom is already applied, so this only copies the exposed part
 	QPainter qp(this);
-	//qp.drawImage(rect(),image,srcRect);
-	qp.drawPixmap(dstRect, piximage, srcRect);
+	qp.drawPixmap(e->rect(), scaled, e->rect());
 }
 
 void VramBitMappedView::refresh()
@@ -321,15 +639,15 @@ void VramBitMappedView::mousePressEvent(QMouseEvent* e)
 {
 	// since mouseMove only emits the correct signal we reuse/abuse that method
 	mouseMoveEvent(e);
-
-	decodePallet();
-	decode();
-	update();
 }
 
 void VramBitMappedView::setBorderColor(int value)
 {
-	borderColor = clip<0, 15>(value);
+	value = clip<0, 15>(value);
+	if (value == borderColor) return;
+	borderColor = value;
+	// screen 8 and up don't show colour 0 through the palette
+	if (screenMode >= 8) return;
 	decodePallet();
 	decode();
 	update();
@@ -347,6 +665,7 @@ void VramBitMappedView::setLines(int nrLines)
 	lines = nrLines;
 	decode();
 	setFixedSize(int(512 * zoomFactor), int(lines * 2 * zoomFactor));
+	rescale();
 	update();
 	//setZoom(zoomFactor);
 }
@@ -367,6 +686,12 @@ void VramBitMappedView::setVramSource(const unsigned char* adr)
 	update();
 }
 
+void VramBitMappedView::setDiffSource(const unsigned char* adr)
+{
+	diffBase = adr;
+	decode();
+}
+
 void VramBitMappedView::setPaletteSource(const unsigned char* adr)
 {
 	pallet = adr;
@@ -1,18 +1,23 @@
 #ifndef VRAMBITMAPPEDVIEW
 #define VRAMBITMAPPEDVIEW
 
+#include "VDPDataStore.h"
 #include <QString>
 #include <QWidget>
 #include <QImage>
 #include <QPixmap>
 #include <QMouseEvent>
 #include <QColor>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QThreadPool>
 
 class VramBitMappedView : public QWidget
 {
 	Q_OBJECT
 public:
 	VramBitMappedView(QWidget* parent = 0);
+	~VramBitMappedView();
 
 	void setZoom(float zoom);
 
@@ -22,12 +27,16 @@ public:
 	void setVramAddress(int adr);
 	void setPaletteSource(const unsigned char* adr);
 	void setBorderColor(int value);
+	// dims the pixels that are the same in this VRAM, NULL shows all
+	void setDiffSource(const unsigned char* adr);
 
 	void mousePressEvent(QMouseEvent* e);
 	void mouseMoveEvent (QMouseEvent* e);
 
 public slots:
 	void refresh();
+	// redecodes the lines that show VRAM in ranges
+	void vramChanged(const QList<VramRange>& ranges);
 
 signals:
 	void imageChanged();
@@ -36,31 +45,77 @@ signals:
 	void imageClicked (int xcoormsx, int ycoormsx, int color,
 	                   unsigned addr, int byte);
 
+private slots:
+	void decodeFinished();
+
 private:
-	void paintEvent(QPaintEvent*);
+	// everything the decoders read, copied when a decode starts
+	struct DecodeState {
+		QByteArray vram;
+		// the VRAM to compare with, empty when not comparing
+		QByteArray previous;
+		QRgb pallet[16];
+		// the pallet with the border colour for colour 0
+		QRgb colors[16];
+		// the colours of the pixels in a byte of screen 5 and 7 (nibbles)
+		// and of screen 6 (2 bits)
+		QRgb nibbles[256][2];
+		QRgb crumbs[256][4];
+		unsigned vramAddress;
+		int screenMode;
+		// the lines of image, the workers don't touch the QImage itself
+		unsigned char* bits;
+		int bytesPerLine;
+	};
+
+	void paintEvent(QPaintEvent* e);
+	void rescale();
+	void updateScaled(const QRect& area);
+	QRect scaledRect(const QRect& area) const;
 
 	void decode();
+	void decodeLines(int first, int last);
+	void copyState();
+	void decodeBand(int first, int last);
 	void decodePallet();
-	void decodeSCR5();
-	void decodeSCR6();
-	void decodeSCR7();
-	void decodeSCR8();
-	void decodeSCR10();
-	void decodeSCR12();
-	void setPixel2x2(int x, int y, QRgb c);
-	void setPixel1x2(int x, int y, QRgb c);
+	static void decodeSCR5 (const DecodeState& s, int first, int last);
+	static void decodeSCR6 (const DecodeState& s, int first, int last);
+	static void decodeSCR7 (const DecodeState& s, int first, int last);
+	static void decodeSCR8 (const DecodeState& s, int first, int last);
+	static void decodeSCR10(const DecodeState& s, int first, int last);
+	static void decodeSCR12(const DecodeState& s, int first, int last);
+	static void markChanges(const DecodeState& s, int first, int last);
 	QRgb getColor(int c);
 
 	QRgb msxpallet[16];
+	// the workers decode into image while piximage is shown
 	QImage image;
 	QPixmap piximage;
+	// piximage at the current zoom, painting only copies from it
+	QPixmap scaled;
 	const unsigned char* pallet;
 	const unsigned char* vramBase;
+	const unsigned char* diffBase;
 	float zoomFactor;
 	unsigned int vramAddress;
 	int lines;
 	int screenMode;
 	int borderColor;
+
+	DecodeState state;
+	QThreadPool pool;
+	QAtomicInt bandsLeft;
+	bool decoding;
+	// lines of the running decode
+	int decodedFirst;
+	int decodedLast;
+	// lines to decode once the running decode is done
+	int pendingFirst;
+	int pendingLast;
+
+	friend class DecodeBandTask;
+	// bench/DecodeBenchmark.cpp times the decoders
+	friend class DecodeBenchmark;
 };
 
 #endif // VRAMBITMAPPEDVIEW
@@ -0,0 +1,169 @@
+#include "VramHistory.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static const int PAGE_SIZE = 1024;
+
+/* A delta is a list of the pages that changed. Each starts with its page
+ * number in two bytes, followed by runs of its XOR bytes until the page is
+ * complete: a byte 0x80 + n skips n + 1 unchanged bytes, a byte n < 0x80
+ * is followed by n + 1 bytes to XOR.
+ */
+static void encodeDelta(const unsigned char* a, const unsigned char* b, int size,
+                        QByteArray& out)
+{
+	for (int start = 0; start < size; start += PAGE_SIZE) {
+		int len = std::min(PAGE_SIZE, size - start);
+		const unsigned char* x = a + start;
+		const unsigned char* y = b + start;
+		if (memcmp(x, y, len) == 0) continue;
+
+		int page = start / PAGE_SIZE;
+		out.append(char(page >> 8));
+		out.append(char(page & 0xFF));
+		int i = 0;
+		while (i < len) {
+			int n = 0;
+			while (i + n < len && n < 128 && x[i + n] == y[i + n]) ++n;
+			if (n) {
+				out.append(char(0x80 | (n - 1)));
+				i += n;
+				continue;
+			}
+			while (i + n < len && n < 128 && x[i + n] != y[i + n]) ++n;
+			out.append(char(n - 1));
+			for (int k = 0; k < n; ++k) {
+				out.append(char(x[i + k] ^ y[i + k]));
+			}
+			i += n;
+		}
+	}
+}
+
+static void applyDelta(const QByteArray& delta, unsigned char* data, int size)
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(delta.constData());
+	const unsigned char* end = in + delta.size();
+	while (in < end) {
+		int start = ((in[0] << 8) | in[1]) * PAGE_SIZE;
+		in += 2;
+		unsigned char* out = data + start;
+		unsigned char* pageEnd = out + std::min(PAGE_SIZE, size - start);
+		while (out < pageEnd) {
+			int run = *in++;
+			if (run & 0x80) {
+				out += (run & 0x7F) + 1;
+			} else {
+				for (int k = 0; k <= run; ++k) {
+					*out++ ^= *in++;
+				}
+			}
+		}
+	}
+}
+
+
+VramHistory::VramHistory(int budget_)
+	: firstSerial(0)
+	, lastSerial(-1)
+	, used(0)
+	, budget(budget_)
+	, cachedSerial(0)
+	, haveCached(false)
+{
+}
+
+void VramHistory::clear()
+{
+	latest.clear();
+	deltas.clear();
+	cached.clear();
+	haveCached = false;
+	used = 0;
+	// the serial numbers keep counting, an old one never comes back
+	firstSerial = lastSerial + 1;
+}
+
+void VramHistory::setBudget(int bytes)
+{
+	budget = bytes;
+	while (used > budget && !deltas.empty()) dropOldest();
+}
+
+int VramHistory::memoryUsed() const
+{
+	return used;
+}
+
+bool VramHistory::add(const unsigned char* data, int size)
+{
+	if (latest.size() != size) {
+		clear();
+		latest = QByteArray(reinterpret_cast<const char*>(data), size);
+		used = size;
+		firstSerial = ++lastSerial;
+		return true;
+	}
+
+	QByteArray delta;
+	const unsigned char* old = reinterpret_cast<const unsigned char*>(latest.constData());
+	encodeDelta(old, data, size, delta);
+	if (delta.isEmpty()) return false;
+
+	memcpy(latest.data(), data, size);
+	deltas.push_back(delta);
+	used += delta.size();
+	++lastSerial;
+	while (used > budget && !deltas.empty()) dropOldest();
+	return true;
+}
+
+void VramHistory::dropOldest()
+{
+	used -= deltas.front().size();
+	deltas.pop_front();
+	++firstSerial;
+	if (haveCached && cachedSerial < firstSerial) {
+		cached.clear();
+		haveCached = false;
+	}
+}
+
+int VramHistory::oldest() const
+{
+	return firstSerial;
+}
+
+int VramHistory::newest() const
+{
+	return lastSerial;
+}
+
+bool VramHistory::snapshot(int serial, QByteArray& out)
+{
+	if (serial < firstSerial || serial > lastSerial) return false;
+	if (serial == lastSerial) {
+		out = latest;
+		return true;
+	}
+
+	// start from whichever is closer, the newest or the cached snapshot
+	if (!haveCached || std::abs(cachedSerial - serial) > lastSerial - serial) {
+		cached = latest;
+		cachedSerial = lastSerial;
+		haveCached = true;
+	}
+	unsigned char* data = reinterpret_cast<unsigned char*>(cached.data());
+	int size = cached.size();
+	while (cachedSerial > serial) {
+		--cachedSerial;
+		applyDelta(deltas[cachedSerial - firstSerial], data, size);
+	}
+	while (cachedSerial < serial) {
+		applyDelta(deltas[cachedSerial - firstSerial], data, size);
+		++cachedSerial;
+	}
+	out = cached;
+	return true;
+}
@@ -0,0 +1,56 @@
+#ifndef VRAMHISTORY_H
+#define VRAMHISTORY_H
+
+#include <QByteArray>
+#include <deque>
+
+/** The VDP data of the latest refreshes. Only the newest snapshot is kept
+  * whole, every older one is stored as the XOR with the snapshot after
+  * it, run length encoded per 1kB page, so unchanged pages cost nothing.
+  * When the deltas don't fit in the memory budget any more, the oldest
+  * snapshots are dropped.
+  */
+class VramHistory
+{
+public:
+	VramHistory(int budget = 16 << 20);
+
+	void clear();
+	void setBudget(int bytes);
+	int memoryUsed() const;
+
+	/** Adds a snapshot after the newest one. A snapshot of another size
+	  * starts a new history. Returns false if nothing changed since the
+	  * newest snapshot, then no snapshot is added.
+	  */
+	bool add(const unsigned char* data, int size);
+
+	// every snapshot gets the next serial number, newest() is smaller
+	// than oldest() when the history is empty
+	int oldest() const;
+	int newest() const;
+
+	/** Copies a snapshot into out, returns false if it's not in the history.
+	  * Stepping from the previously asked snapshot or from the newest one
+	  * only applies the deltas in between.
+	  */
+	bool snapshot(int serial, QByteArray& out);
+
+private:
+	void dropOldest();
+
+	QByteArray latest;
+	// deltas[i] turns snapshot firstSerial + i + 1 into the one before and back
+	std::deque<QByteArray> deltas;
+	int firstSerial;
+	int lastSerial;
+	int used;
+	int budget;
+
+	// the snapshot that was asked last
+	QByteArray cached;
+	int cachedSerial;
+	bool haveCached;
+};
+
+#endif // VRAMHISTORY_H
@@ -0,0 +1,437 @@
+#include "VramTiledView.h"
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <algorithm>
+#include <cstring>
+
+// the tile modes address at most 128kB
+static const unsigned VRAM_MASK = 0x1FFFF;
+// all glyphs are forgotten beyond this, live updates keep adding new ones
+static const int MAX_GLYPHS = 4096;
+// the end marker of the sprite attribute table, for sprite mode 1 and 2
+static const int SPRITE_END_MODE1 = 208;
+static const int SPRITE_END_MODE2 = 216;
+
+// a byte for each of the 8 rows
+static inline quint64 repeat8(int value)
+{
+	return quint64(value & 0xFF) * Q_UINT64_C(0x0101010101010101);
+}
+
+// the multicolour screen shows the colours as blocks of 4x4 pixels, which
+// is the pattern 0xF0 with the two colours of the block pair
+static const quint64 MULTICOLOR_PATTERN = Q_UINT64_C(0xF0F0F0F0F0F0F0F0);
+
+
+GlyphCache::GlyphCache()
+{
+	for (int i = 0; i < 16; ++i) {
+		colors[i] = 0;
+	}
+}
+
+bool GlyphCache::setColors(const QRgb* palette, QRgb transparent)
+{
+	QRgb newColors[16];
+	newColors[0] = transparent;
+	for (int i = 1; i < 16; ++i) {
+		newColors[i] = palette[i];
+	}
+	if (memcmp(newColors, colors, sizeof(colors)) == 0) return false;
+	memcpy(colors, newColors, sizeof(colors));
+	glyphs.clear();
+	return true;
+}
+
+const GlyphCache::Glyph& GlyphCache::glyph(const Key& key)
+{
+	QHash<Key, Glyph>::const_iterator it = glyphs.constFind(key);
+	if (it != glyphs.constEnd()) return *it;
+
+	if (glyphs.size() >= MAX_GLYPHS) glyphs.clear();
+	Glyph g;
+	for (int row = 0; row < 8; ++row) {
+		int shift = 56 - 8 * row;
+		int pattern = (key.first  >> shift) & 0xFF;
+		int color   = (key.second >> shift) & 0xFF;
+		QRgb fg = colors[color >> 4];
+		QRgb bg = colors[color & 15];
+		for (int x = 0; x < 8; ++x) {
+			g.pixels[8 * row + x] = (pattern & (0x80 >> x)) ? fg : bg;
+		}
+	}
+	return *glyphs.insert(key, g);
+}
+
+
+VramTiledView::VramTiledView(QWidget* parent)
+	: QWidget(parent)
+{
+	vramBase = NULL;
+	regs = NULL;
+	pallet = NULL;
+	for (int i = 0; i < 16; ++i) {
+		msxpallet[i] = qRgb(80, 80, 80);
+	}
+	drawMode = NAMES;
+	zoomFactor = 2;
+	mode = -1;
+	nameTable = patternTable = colorTable = 0;
+	patternMask = colorMask = 0;
+	spriteAttributes = spriteColors = spritePatterns = 0;
+	columns = 32;
+	glyphWidth = 8;
+	textColors = 0;
+	bigSprites = false;
+	imageColumns = 32;
+	cellWidth = 8;
+
+	setMouseTracking(true);
+}
+
+void VramTiledView::setDrawMode(DrawMode newMode)
+{
+	drawMode = newMode;
+	shownKeys.clear();
+	render();
+}
+
+void VramTiledView::setZoom(int zoom)
+{
+	zoomFactor = std::max(1, zoom);
+	setFixedSize(image.size() * zoomFactor);
+	update();
+}
+
+void VramTiledView::setVramSource(const unsigned char* adr)
+{
+	vramBase = adr;
+}
+
+void VramTiledView::setRegsSource(const unsigned char* adr)
+{
+	regs = adr;
+}
+
+void VramTiledView::setPaletteSource(const unsigned char* adr)
+{
+	pallet = adr;
+}
+
+int VramTiledView::screenMode() const
+{
+	return mode;
+}
+
+void VramTiledView::refresh()
+{
+	if (!regs) return;
+	decodeRegs();
+	decodePalette();
+	bool changed = tileGlyphs.setColors(msxpallet, msxpallet[regs[7] & 15]);
+	// transparent sprite pixels are shown on dark grey
+	if (spriteGlyphs.setColors(msxpallet, qRgb(64, 64, 64))) changed = true;
+	if (changed) shownKeys.clear();
+	render();
+}
+
+void VramTiledView::vramChanged(const QList<VramRange>& ranges)
+{
+	// comparing the keys of all cells is cheap, and the tables can be
+	// anywhere, so the ranges themselves aren't looked at
+	render();
+}
+
+void VramTiledView::decodeRegs()
+{
+	// the mode bits, as BitMapViewer::decodeVDPregs() combines them
+	int bits = ((regs[0] & 0x0E) << 1) | ((regs[1] & 0x18) >> 3);
+	switch (bits) {
+	case 0x00: mode =  1; break;
+	case 0x01: mode =  3; break;
+	case 0x02: mode =  0; break;
+	case 0x04: mode =  2; break;
+	case 0x08: mode =  4; break;
+	case 0x0A: mode = 80; break;
+	default:   mode = -1; break;
+	}
+
+	columns = (mode == 0) ? 40 : (mode == 80) ? 80 : 32;
+	glyphWidth = (mode == 0 || mode == 80) ? 6 : 8;
+	nameTable = ((mode == 80) ? (regs[2] & 0x7C) : (regs[2] & 0x7F)) << 10;
+
+	unsigned high = (regs[10] & 7) << 14;
+	if (mode == 2 || mode == 4) {
+		// the low bits of the table addresses mask the thirds of the screen
+		patternTable = (regs[4] & 0x3C) << 11;
+		patternMask = ((regs[4] & 3) << 11) | 0x7FF;
+		colorTable = high | ((regs[3] & 0x80) << 6);
+		colorMask = ((regs[3] & 0x7F) << 6) | 0x3F;
+	} else {
+		patternTable = (regs[4] & 0x3F) << 11;
+		patternMask = 0x7FF;
+		colorTable = high | (regs[3] << 6);
+		colorMask = 0x3F;
+	}
+
+	spriteAttributes = ((regs[11] & 3) << 15) | (regs[5] << 7);
+	if (mode == 4) {
+		// sprite mode 2 has a colour table right before the attributes
+		spriteColors = spriteAttributes & ~0x3FF;
+		spriteAttributes = spriteColors + 0x200;
+	} else {
+		spriteColors = 0;
+	}
+	spritePatterns = (regs[6] & 0x3F) << 11;
+	bigSprites = regs[1] & 2;
+	textColors = regs[7];
+}
+
+void VramTiledView::decodePalette()
+{
+	if (!pallet) return;
+
+	for (int i = 0; i < 16; ++i) {
+		int r = (pallet[2 * i + 0] & 0xf0) >> 4;
+		int b = (pallet[2 * i + 0] & 0x0f);
+		int g = (pallet[2 * i + 1] & 0x0f);
+
+		r = (r >> 1) | (r << 2) | (r << 5);
+		b = (b >> 1) | (b << 2) | (b << 5);
+		g = (g >> 1) | (g << 2) | (g << 5);
+
+		msxpallet[i] = qRgb(r, g, b);
+	}
+}
+
+int VramTiledView::vramByte(unsigned addr) const
+{
+	return vramBase[addr & VRAM_MASK];
+}
+
+quint64 VramTiledView::vramBytes(unsigned addr) const
+{
+	quint64 result = 0;
+	for (unsigned i = 0; i < 8; ++i) {
+		result = (result << 8) | vramByte(addr + i);
+	}
+	return result;
+}
+
+unsigned VramTiledView::patternAddress(int pattern) const
+{
+	return patternTable | ((8 * pattern) & patternMask);
+}
+
+unsigned VramTiledView::colorAddress(int pattern) const
+{
+	if (mode == 1) return colorTable + pattern / 8;
+	return colorTable | ((8 * pattern) & colorMask);
+}
+
+GlyphCache::Key VramTiledView::patternKey(int pattern) const
+{
+	switch (mode) {
+	case 0:
+	case 80:
+		return GlyphCache::Key(vramBytes(patternAddress(pattern)), repeat8(textColors));
+	case 3:
+		return GlyphCache::Key(MULTICOLOR_PATTERN, vramBytes(patternAddress(pattern)));
+	case 1:
+		return GlyphCache::Key(vramBytes(patternAddress(pattern)),
+		                       repeat8(vramByte(colorAddress(pattern))));
+	default:
+		return GlyphCache::Key(vramBytes(patternAddress(pattern)),
+		                       vramBytes(colorAddress(pattern)));
+	}
+}
+
+void VramTiledView::patternKeys(QVector<GlyphCache::Key>& keys) const
+{
+	// screen 2 and 4 have a pattern generator for each third of the screen
+	keys.resize((mode == 2 || mode == 4) ? 768 : 256);
+	for (int i = 0; i < keys.size(); ++i) {
+		keys[i] = patternKey(i);
+	}
+}
+
+void VramTiledView::nameKeys(QVector<GlyphCache::Key>& keys) const
+{
+	keys.resize(24 * columns);
+	for (int row = 0; row < 24; ++row) {
+		for (int col = 0; col < columns; ++col) {
+			int name = vramByte(nameTable + row * columns + col);
+			GlyphCache::Key& key = keys[row * columns + col];
+			if (mode == 3) {
+				// a pattern holds the blocks of four rows of names
+				unsigned addr = patternAddress(name) + 2 * (row & 3);
+				quint64 top    = repeat8(vramByte(addr + 0)) & Q_UINT64_C(0xFFFFFFFF00000000);
+				quint64 bottom = repeat8(vramByte(addr + 1)) & Q_UINT64_C(0x00000000FFFFFFFF);
+				key = GlyphCache::Key(MULTICOLOR_PATTERN, top | bottom);
+			} else if (mode == 2 || mode == 4) {
+				key = patternKey(256 * (row / 8) + name);
+			} else {
+				key = patternKey(name);
+			}
+		}
+	}
+}
+
+void VramTiledView::spriteKeys(QVector<GlyphCache::Key>& keys) const
+{
+	// the text modes have no sprites
+	if (mode == 0 || mode == 80) return;
+
+	// a 16x16 sprite is four 8x8 quadrants, stored in the order top left,
+	// bottom left, top right, bottom right
+	int size = bigSprites ? 2 : 1;
+	int cols = 8 * size;
+	keys.resize(32 * size * size);
+	for (int n = 0; n < 32; ++n) {
+		unsigned attr = spriteAttributes + 4 * n;
+		int pattern = vramByte(attr + 2);
+		if (bigSprites) pattern &= 0xFC;
+		for (int q = 0; q < size * size; ++q) {
+			int qx = q / 2;
+			int qy = q % 2;
+			// sprite mode 2 has a colour for each line
+			quint64 colors = 0;
+			for (int line = 0; line < 8; ++line) {
+				int c = (mode == 4)
+				      ? vramByte(spriteColors + 16 * n + 8 * qy + line)
+				      : vramByte(attr + 3);
+				colors = (colors << 8) | ((c & 15) << 4);
+			}
+			int cell = ((n / 8) * size + qy) * cols + (n % 8) * size + qx;
+			keys[cell] = GlyphCache::Key(
+				vramBytes(spritePatterns + 8 * (pattern + q)), colors);
+		}
+	}
+}
+
+void VramTiledView::render()
+{
+	if (!vramBase || !regs) return;
+
+	QVector<GlyphCache::Key> keys;
+	if (mode != -1) {
+		switch (drawMode) {
+		case PATTERNS:
+			patternKeys(keys);
+			imageColumns = 32;
+			break;
+		case NAMES:
+			nameKeys(keys);
+			imageColumns = columns;
+			break;
+		case SPRITES:
+			spriteKeys(keys);
+			imageColumns = bigSprites ? 16 : 8;
+			break;
+		}
+	}
+	cellWidth = (drawMode == SPRITES) ? 8 : glyphWidth;
+
+	int rows = keys.size() / imageColumns;
+	QSize size(imageColumns * cellWidth, rows * 8);
+	bool all = keys.size() != shownKeys.size();
+	if (image.size() != size) {
+		image = QImage(size, QImage::Format_RGB32);
+		setFixedSize(size * zoomFactor);
+		all = true;
+	}
+
+	GlyphCache& glyphs = (drawMode == SPRITES) ? spriteGlyphs : tileGlyphs;
+	QRect dirty;
+	for (int i = 0; i < keys.size(); ++i) {
+		if (!all && keys[i] == shownKeys[i]) continue;
+		const GlyphCache::Glyph& g = glyphs.glyph(keys[i]);
+		int x = (i % imageColumns) * cellWidth;
+		int y = (i / imageColumns) * 8;
+		for (int line = 0; line < 8; ++line) {
+			QRgb* out = reinterpret_cast<QRgb*>(image.scanLine(y + line)) + x;
+			memcpy(out, g.pixels + 8 * line, cellWidth * sizeof(QRgb));
+		}
+		dirty |= QRect(x, y, cellWidth, 8);
+	}
+	shownKeys = keys;
+	if (all) {
+		update();
+	} else if (!dirty.isEmpty()) {
+		update(QRect(dirty.topLeft() * zoomFactor, dirty.size() * zoomFactor));
+	}
+}
+
+void VramTiledView::paintEvent(QPaintEvent* e)
+{
+	if (image.isNull()) return;
+	// only the exposed cells are scaled
+	QRect r = e->rect();
+	QRect src(r.x() / zoomFactor, r.y() / zoomFactor,
+	          r.width() / zoomFactor + 2, r.height() / zoomFactor + 2);
+	src &= image.rect();
+	QPainter qp(this);
+	qp.drawImage(QRect(src.topLeft() * zoomFactor, src.size() * zoomFactor),
+	             image, src);
+}
+
+void VramTiledView::mouseMoveEvent(QMouseEvent* e)
+{
+	if (shownKeys.isEmpty()) return;
+	int col = e->x() / zoomFactor / cellWidth;
+	int row = e->y() / zoomFactor / 8;
+	if (e->x() < 0 || e->y() < 0 || col >= imageColumns ||
+	    row >= shownKeys.size() / imageColumns) return;
+	emit tileInfo(cellInfo(col, row));
+}
+
+static QString hexAddress(unsigned addr)
+{
+	return QString("0x%1").arg(addr, 5, 16, QChar('0'));
+}
+
+QString VramTiledView::cellInfo(int column, int row) const
+{
+	switch (drawMode) {
+	case PATTERNS: {
+		int pattern = 32 * row + column;
+		QString text = tr("Pattern %1 at %2")
+			.arg(pattern).arg(hexAddress(patternAddress(pattern)));
+		if (mode == 1 || mode == 2 || mode == 4) {
+			text += tr(", colours at %1").arg(hexAddress(colorAddress(pattern)));
+		}
+		return text;
+	}
+	case NAMES: {
+		unsigned addr = nameTable + row * columns + column;
+		return tr("Column %1, row %2: name %3 at %4")
+			.arg(column).arg(row).arg(vramByte(addr)).arg(hexAddress(addr));
+	}
+	case SPRITES: {
+		int size = bigSprites ? 2 : 1;
+		int n = (row / size) * 8 + column / size;
+		unsigned attr = spriteAttributes + 4 * n;
+		QString text = tr("Sprite %1 at %2: x %3, y %4, pattern %5")
+			.arg(n).arg(hexAddress(attr)).arg(vramByte(attr + 1))
+			.arg(vramByte(attr)).arg(vramByte(attr + 2));
+		if (mode != 4) {
+			int c = vramByte(attr + 3);
+			text += tr(", colour %1").arg(c & 15);
+			if (c & 0x80) text += tr(", early clock");
+		} else {
+			text += tr(", colours at %1").arg(hexAddress(spriteColors + 16 * n));
+		}
+		// sprites after the end marker aren't shown
+		int end = (mode == 4) ? SPRITE_END_MODE2 : SPRITE_END_MODE1;
+		for (int i = 0; i <= n; ++i) {
+			if (vramByte(spriteAttributes + 4 * i) == end) {
+				text += tr(" (hidden, sprite %1 ends the table)").arg(i);
+				break;
+			}
+		}
+		return text;
+	}
+	}
+	return QString();
+}
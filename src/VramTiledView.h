@@ -0,0 +1,115 @@
+#ifndef VRAMTILEDVIEW_H
+#define VRAMTILEDVIEW_H
+
+#include "VDPDataStore.h"
+#include <QWidget>
+#include <QImage>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+/** Decoded 8x8 glyphs, keyed by their eight pattern bytes and their eight
+  * colour bytes. The same glyph usually shows up all over the screen, so
+  * it's decoded once and then copied, until the colours change.
+  */
+class GlyphCache
+{
+public:
+	// the bytes of the rows, row 0 in the top byte
+	typedef QPair<quint64, quint64> Key;
+	struct Glyph {
+		QRgb pixels[64];
+	};
+
+	GlyphCache();
+
+	// colour 0 is drawn as transparent, returns true if the colours changed
+	bool setColors(const QRgb* palette, QRgb transparent);
+	const Glyph& glyph(const Key& key);
+
+private:
+	QHash<Key, Glyph> glyphs;
+	QRgb colors[16];
+};
+
+/** Shows the pattern generator, the name table or the sprites of the
+  * tile based screens 0 to 4, as the VDP registers set them up.
+  */
+class VramTiledView : public QWidget
+{
+	Q_OBJECT
+public:
+	enum DrawMode { PATTERNS, NAMES, SPRITES };
+
+	VramTiledView(QWidget* parent = 0);
+
+	void setDrawMode(DrawMode newMode);
+	void setZoom(int zoom);
+	// the sources are only read by refresh() and vramChanged(), the
+	// registers and palette only by refresh()
+	void setVramSource(const unsigned char* adr);
+	void setRegsSource(const unsigned char* adr);
+	void setPaletteSource(const unsigned char* adr);
+
+	// screen 0 to 4 (80 for screen 0 width 80), -1 for the other modes
+	int screenMode() const;
+
+public slots:
+	void refresh();
+	void vramChanged(const QList<VramRange>& ranges);
+
+signals:
+	void tileInfo(const QString& text);
+
+protected:
+	void paintEvent(QPaintEvent* e);
+	void mouseMoveEvent(QMouseEvent* e);
+
+private:
+	void decodeRegs();
+	void decodePalette();
+	void render();
+	void patternKeys(QVector<GlyphCache::Key>& keys) const;
+	void nameKeys(QVector<GlyphCache::Key>& keys) const;
+	void spriteKeys(QVector<GlyphCache::Key>& keys) const;
+	GlyphCache::Key patternKey(int pattern) const;
+	unsigned patternAddress(int pattern) const;
+	unsigned colorAddress(int pattern) const;
+	quint64 vramBytes(unsigned addr) const;
+	int vramByte(unsigned addr) const;
+	QString cellInfo(int column, int row) const;
+
+	const unsigned char* vramBase;
+	const unsigned char* regs;
+	const unsigned char* pallet;
+	QRgb msxpallet[16];
+
+	DrawMode drawMode;
+	int zoomFactor;
+
+	// the tables and layout the registers select
+	int mode;
+	unsigned nameTable;
+	unsigned patternTable;
+	unsigned patternMask;
+	unsigned colorTable;
+	unsigned colorMask;
+	unsigned spriteAttributes;
+	unsigned spriteColors;
+	unsigned spritePatterns;
+	int columns;
+	int glyphWidth;
+	bool bigSprites;
+	// the colours of the text modes, register 7
+	int textColors;
+
+	GlyphCache tileGlyphs;
+	GlyphCache spriteGlyphs;
+	QImage image;
+	// what each cell of image shows, only the changed cells are redrawn
+	QVector<GlyphCache::Key> shownKeys;
+	int imageColumns;
+	int cellWidth;
+};
+
+#endif // VRAMTILEDVIEW_H
@@ -10,11 +10,15 @@ MOC_SRC_HDR:= \
 	Settings PreferencesDialog BreakpointDialog DebuggableViewer \
 	DebugSession MainMemoryViewer BitMapViewer VramBitMappedView \
 	VDPDataStore VDPStatusRegViewer VDPRegViewer InteractiveLabel \
-	InteractiveButton VDPCommandRegViewer GotoDialog SymbolTable
+	InteractiveButton VDPCommandRegViewer GotoDialog SymbolTable \
+	Profiler ProfilerViewer CoverageCollector CoverageViewer \
+	TraceRecorder TraceViewer MemoryHeatmap HeatmapViewer \
+	TracepointLog TracepointViewer LabelCompleter SourceViewer \
+	VramTiledView TileViewer
 
 SRC_HDR:= \
 	DockManager Dasm DasmTables DebuggerData SymbolTable Convert Version \
-	CPURegs SimpleHexRequest
+	CPURegs SimpleHexRequest TraceBuffer SourceMap VramHistory
 
 SRC_ONLY:= \
 	main